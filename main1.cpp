@@ -8,6 +8,9 @@
 #include <map>
 #include <set>
 #include <fstream>
+#include <string_view>
+#include "test/token.h"
+#include "test/keywords.h"
 
 using namespace std;
 
@@ -325,24 +328,8 @@ void writeParsingInfoToFile(const vector<Production>& grammar,
 // ===========================
 
 // --- Token Definitions for SQL ---
-enum class TokenType {
-    // Keywords
-    CREATE, TABLE, PRIMARY, KEY, INSERT, INTO, VALUES, SELECT, FROM, WHERE,
-    BETWEEN, AND, LIKE, IN,
-    // Symbols
-    LPAREN, RPAREN, COMMA, SEMICOLON, ASTERISK,
-    // Operators
-    EQUAL, GREATER, LESS,
-    // Identifier and literal types
-    IDENTIFIER, NUMBER, STRING,
-    // End marker
-    END
-};
-
-struct Token {
-    TokenType type;
-    string lexeme;
-};
+// TokenType, Token and the keyword table are shared with the test/ compiler
+// (test/token.h, test/keywords.h).
 
 // --- Lexical Analyzer ---
 class Lexer {
@@ -359,14 +346,14 @@ public:
             }
             char current = input[pos];
             if (isalpha(current) || current == '_') {
-                string word = readWord();
+                string_view word = readWord();
                 Token token = keywordOrIdentifier(word);
                 tokens.push_back(token);
             } else if (isdigit(current)) {
-                string num = readNumber();
+                string_view num = readNumber();
                 tokens.push_back({TokenType::NUMBER, num});
             } else if (current == '\'' || current == '\"') {
-                string str = readString();
+                string_view str = readString();
                 tokens.push_back({TokenType::STRING, str});
             } else {
                 switch (current) {
@@ -394,13 +381,14 @@ private:
         while (pos < input.size() && isspace(input[pos]))
             pos++;
     }
-    string readWord() {
+    // Lexemes are views into `input`, so tokens stay valid while the Lexer lives.
+    string_view readWord() {
         size_t start = pos;
         while (pos < input.size() && (isalnum(input[pos]) || input[pos]=='_'))
             pos++;
-        return input.substr(start, pos - start);
+        return string_view(input).substr(start, pos - start);
     }
-    string readNumber() {
+    string_view readNumber() {
         size_t start = pos;
         while (pos < input.size() && isdigit(input[pos]))
             pos++;
@@ -409,36 +397,20 @@ private:
             while (pos < input.size() && isdigit(input[pos]))
                 pos++;
         }
-        return input.substr(start, pos - start);
+        return string_view(input).substr(start, pos - start);
     }
-    string readString() {
+    string_view readString() {
         char quote = input[pos];
         pos++; // skip opening
         size_t start = pos;
         while (pos < input.size() && input[pos]!=quote)
             pos++;
-        string str = input.substr(start, pos - start);
+        string_view str = string_view(input).substr(start, pos - start);
         pos++; // skip closing
         return str;
     }
-    Token keywordOrIdentifier(const string &word) {
-        string upperWord = word;
-        transform(upperWord.begin(), upperWord.end(), upperWord.begin(), ::toupper);
-        if (upperWord=="CREATE") return {TokenType::CREATE, word};
-        if (upperWord=="TABLE")  return {TokenType::TABLE, word};
-        if (upperWord=="PRIMARY") return {TokenType::PRIMARY, word};
-        if (upperWord=="KEY") return {TokenType::KEY, word};
-        if (upperWord=="INSERT") return {TokenType::INSERT, word};
-        if (upperWord=="INTO") return {TokenType::INTO, word};
-        if (upperWord=="VALUES") return {TokenType::VALUES, word};
-        if (upperWord=="SELECT") return {TokenType::SELECT, word};
-        if (upperWord=="FROM") return {TokenType::FROM, word};
-        if (upperWord=="WHERE") return {TokenType::WHERE, word};
-        if (upperWord=="BETWEEN") return {TokenType::BETWEEN, word};
-        if (upperWord=="AND") return {TokenType::AND, word};
-        if (upperWord=="LIKE") return {TokenType::LIKE, word};
-        if (upperWord=="IN") return {TokenType::IN, word};
-        return {TokenType::IDENTIFIER, word};
+    Token keywordOrIdentifier(string_view word) {
+        return {lookupKeyword(word), word};
     }
 };
 
@@ -466,7 +438,7 @@ void ll1Parse(const vector<Token>& tokens, const vector<Production>& grammar,
                 case TokenType::IDENTIFIER: inputSymbol = "id"; break;
                 case TokenType::NUMBER: inputSymbol = "num"; break;
                 case TokenType::STRING: inputSymbol = "str"; break;
-                default: inputSymbol = tokens[i].lexeme; break;
+                default: inputSymbol = string(tokens[i].lexeme); break;
             }
         }
         
@@ -0,0 +1,27 @@
+// Example program embedding libsqlparser.a (parser_api.h): reads SQL from
+// standard input, one line at a time, and prints the syntax errors of each
+// line, followed by totals. One session serves every line, so after the
+// first few lines it parses without allocating.
+// Usage: ./app < script.sql
+#include <iostream>
+#include <string>
+#include "parser_api.h"
+using namespace std;
+
+int main() {
+    ParserContext context;
+    ParseSession session(context, ParseOptions{true, 4096});
+    size_t statements = 0, errors = 0, valid = 0;
+    string line;
+    for (size_t lineNo = 1; getline(cin, line); lineNo++) {
+        const ParseResult &r = session.parse(line);
+        for (const auto &error : r.errors)
+            cout << "Line " << lineNo << ", offset " << error.offset << ": " << error.message << '\n';
+        statements += r.statements;
+        errors += r.errors.size();
+        valid += r.ast->size();
+    }
+    cout << statements << " statements, " << errors << " syntax errors, " << valid << " in the AST, "
+         << session.cacheHits() << " cache hits" << endl;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,429 @@
+#include "ast.h"
+#include "parser.h"
+using namespace std;
+
+void Ast::clear() {
+    // Field by field rather than `*this = Ast()`, so a reused Ast keeps its
+    // capacity.
+    text.clear();
+    statements.kind.clear();
+    statements.row.clear();
+    statements.offset.clear();
+    createTables.table.clear();
+    createTables.firstColumn.clear();
+    createTables.columnCount.clear();
+    createTables.primaryKey.clear();
+    createTables.repeatedKey.clear();
+    columnDefs.name.clear();
+    columnDefs.type.clear();
+    inserts.table.clear();
+    inserts.firstColumn.clear();
+    inserts.columnCount.clear();
+    inserts.firstValue.clear();
+    inserts.valueCount.clear();
+    selects.table.clear();
+    selects.firstColumn.clear();
+    selects.columnCount.clear();
+    selects.condition.clear();
+    selects.conditionColumn.clear();
+    selects.firstValue.clear();
+    selects.valueCount.clear();
+    names.clear();
+    values.kind.clear();
+    values.text.clear();
+    values.symbol.clear();
+}
+
+AstBuilder::AstBuilder(Ast &ast) : ast(ast) {
+    mark = currentMark();
+}
+
+AstBuilder::Mark AstBuilder::currentMark() const {
+    return {ast.text.size(), ast.statements.kind.size(), ast.createTables.table.size(),
+            ast.columnDefs.name.size(), ast.inserts.table.size(), ast.selects.table.size(),
+            ast.names.size(), ast.values.kind.size()};
+}
+
+TextRef AstBuilder::addText(string_view s) {
+    TextRef r = {static_cast<uint32_t>(ast.text.size()), static_cast<uint32_t>(s.size())};
+    ast.text.append(s);
+    return r;
+}
+
+// The symbol of an IDENTIFIER token, interned here if the lexer did not.
+uint32_t AstBuilder::symbolOf(const Token &tok) {
+    return tok.symbol != NO_SYMBOL ? tok.symbol : symbolPool().intern(SymbolKind::Identifier, tok.lexeme);
+}
+
+void AstBuilder::beginStatement(StatementKind k, const Token &tok) {
+    kind = k;
+    auto &st = ast.statements;
+    st.kind.push_back(k);
+    st.offset.push_back(tok.offset);
+    uint32_t names = static_cast<uint32_t>(ast.names.size());
+    uint32_t values = static_cast<uint32_t>(ast.values.kind.size());
+    switch (k) {
+        case StatementKind::CreateTable: {
+            auto &c = ast.createTables;
+            st.row.push_back(static_cast<uint32_t>(c.table.size()));
+            c.table.push_back(NO_SYMBOL);
+            c.firstColumn.push_back(static_cast<uint32_t>(ast.columnDefs.name.size()));
+            c.columnCount.push_back(0);
+            c.primaryKey.push_back(NO_SYMBOL);
+            c.repeatedKey.push_back(NO_SYMBOL);
+            state = State::TableName;
+            break;
+        }
+        case StatementKind::Insert: {
+            auto &in = ast.inserts;
+            st.row.push_back(static_cast<uint32_t>(in.table.size()));
+            in.table.push_back(NO_SYMBOL);
+            in.firstColumn.push_back(names);
+            in.columnCount.push_back(0);
+            in.firstValue.push_back(values);
+            in.valueCount.push_back(0);
+            state = State::TableName;
+            break;
+        }
+        case StatementKind::Select: {
+            auto &s = ast.selects;
+            st.row.push_back(static_cast<uint32_t>(s.table.size()));
+            s.table.push_back(NO_SYMBOL);
+            s.firstColumn.push_back(names);
+            s.columnCount.push_back(0);
+            s.condition.push_back(ConditionKind::None);
+            s.conditionColumn.push_back(NO_SYMBOL);
+            s.firstValue.push_back(values);
+            s.valueCount.push_back(0);
+            state = State::Projection;
+            break;
+        }
+    }
+}
+
+void AstBuilder::addValue(const Token &tok) {
+    ValueKind k = tok.type == TokenType::NUMBER ? ValueKind::Number
+                : tok.type == TokenType::STRING ? ValueKind::String
+                                                : ValueKind::Identifier;
+    ast.values.kind.push_back(k);
+    if (k == ValueKind::Identifier) {
+        ast.values.text.push_back(NO_TEXT);
+        ast.values.symbol.push_back(symbolOf(tok));
+    } else {
+        ast.values.text.push_back(addText(tok.lexeme));
+        ast.values.symbol.push_back(tok.symbol);
+    }
+    if (kind == StatementKind::Insert)
+        ast.inserts.valueCount.back()++;
+    else
+        ast.selects.valueCount.back()++;
+}
+
+void AstBuilder::setCondition(ConditionKind k) {
+    ast.selects.condition.back() = k;
+    state = State::Values;
+}
+
+void AstBuilder::token(const Token &tok) {
+    switch (tok.type) {
+        case TokenType::CREATE: beginStatement(StatementKind::CreateTable, tok); break;
+        case TokenType::INSERT: beginStatement(StatementKind::Insert, tok); break;
+        case TokenType::SELECT: beginStatement(StatementKind::Select, tok); break;
+        case TokenType::SEMICOLON:
+            mark = currentMark();
+            state = State::Start;
+            break;
+        case TokenType::PRIMARY: state = State::PrimaryKey; break;
+        case TokenType::VALUES:  state = State::Values; break;
+        case TokenType::FROM:    state = State::TableName; break;
+        case TokenType::WHERE:   state = State::ConditionColumn; break;
+        case TokenType::EQUAL:   setCondition(ConditionKind::Equal); break;
+        case TokenType::GREATER: setCondition(ConditionKind::Greater); break;
+        case TokenType::LESS:    setCondition(ConditionKind::Less); break;
+        case TokenType::BETWEEN: setCondition(ConditionKind::Between); break;
+        case TokenType::LIKE:    setCondition(ConditionKind::Like); break;
+        case TokenType::IN:      setCondition(ConditionKind::In); break;
+        case TokenType::NUMBER:
+        case TokenType::STRING:
+            addValue(tok);
+            break;
+        case TokenType::IDENTIFIER:
+            switch (state) {
+                case State::TableName:
+                    if (kind == StatementKind::CreateTable) {
+                        ast.createTables.table.back() = symbolOf(tok);
+                        state = State::ColumnName;
+                    } else if (kind == StatementKind::Insert) {
+                        ast.inserts.table.back() = symbolOf(tok);
+                        state = State::InsertColumns;
+                    } else {
+                        ast.selects.table.back() = symbolOf(tok);
+                        state = State::Start;
+                    }
+                    break;
+                case State::ColumnName:
+                    ast.columnDefs.name.push_back(symbolOf(tok));
+                    ast.columnDefs.type.push_back(NO_SYMBOL);
+                    ast.createTables.columnCount.back()++;
+                    state = State::ColumnType;
+                    break;
+                case State::ColumnType:
+                    ast.columnDefs.type.back() = symbolOf(tok);
+                    state = State::ColumnName;
+                    break;
+                case State::PrimaryKey:
+                    // The first key stands; a repeat is kept for the semantic pass to reject.
+                    if (ast.createTables.primaryKey.back() == NO_SYMBOL)
+                        ast.createTables.primaryKey.back() = symbolOf(tok);
+                    else if (ast.createTables.repeatedKey.back() == NO_SYMBOL)
+                        ast.createTables.repeatedKey.back() = symbolOf(tok);
+                    state = State::ColumnName;
+                    break;
+                case State::InsertColumns:
+                    ast.names.push_back(symbolOf(tok));
+                    ast.inserts.columnCount.back()++;
+                    break;
+                case State::Projection:
+                    ast.names.push_back(symbolOf(tok));
+                    ast.selects.columnCount.back()++;
+                    break;
+                case State::ConditionColumn:
+                    ast.selects.conditionColumn.back() = symbolOf(tok);
+                    state = State::Condition;
+                    break;
+                case State::Values:
+                    addValue(tok);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;  // Punctuation, TABLE, INTO, KEY, AND, '*'.
+    }
+}
+
+void AstBuilder::rollback() {
+    ast.text.resize(mark.text);
+    auto &st = ast.statements;
+    st.kind.resize(mark.statements);
+    st.row.resize(mark.statements);
+    st.offset.resize(mark.statements);
+    auto &c = ast.createTables;
+    c.table.resize(mark.createTables);
+    c.firstColumn.resize(mark.createTables);
+    c.columnCount.resize(mark.createTables);
+    c.primaryKey.resize(mark.createTables);
+    c.repeatedKey.resize(mark.createTables);
+    ast.columnDefs.name.resize(mark.columnDefs);
+    ast.columnDefs.type.resize(mark.columnDefs);
+    auto &in = ast.inserts;
+    in.table.resize(mark.inserts);
+    in.firstColumn.resize(mark.inserts);
+    in.columnCount.resize(mark.inserts);
+    in.firstValue.resize(mark.inserts);
+    in.valueCount.resize(mark.inserts);
+    auto &s = ast.selects;
+    s.table.resize(mark.selects);
+    s.firstColumn.resize(mark.selects);
+    s.columnCount.resize(mark.selects);
+    s.condition.resize(mark.selects);
+    s.conditionColumn.resize(mark.selects);
+    s.firstValue.resize(mark.selects);
+    s.valueCount.resize(mark.selects);
+    ast.names.resize(mark.names);
+    ast.values.kind.resize(mark.values);
+    ast.values.text.resize(mark.values);
+    ast.values.symbol.resize(mark.values);
+    state = State::Start;
+}
+
+bool ll1Build(const Token *tokens, size_t count, const LL1Table &table,
+              vector<uint16_t> &stack, string &error, Ast &ast) {
+    AstBuilder builder(ast);
+    if (ll1Run(tokens, count, table, stack, error, [&](const Token &tok) { builder.token(tok); }))
+        return true;
+    builder.rollback();
+    return false;
+}
+
+bool lalrBuild(const Token *tokens, size_t count, const LALRTable &table,
+               vector<uint16_t> &stack, string &error, Ast &ast) {
+    AstBuilder builder(ast);
+    if (lalrRun(tokens, count, table, stack, error, [&](const Token &tok) { builder.token(tok); }))
+        return true;
+    builder.rollback();
+    return false;
+}
+
+void appendStatement(Ast &to, const Ast &from, const Token *tokens, size_t count) {
+    // Appends `src` to `dst` with `f` applied to each element.
+    auto append = [](auto &dst, const auto &src, auto f) {
+        for (const auto &x : src)
+            dst.push_back(f(x));
+    };
+    auto same = [](auto x) { return x; };
+    auto shift = [](uint32_t base) { return [base](uint32_t x) { return x + base; }; };
+
+    uint32_t createTables = static_cast<uint32_t>(to.createTables.table.size());
+    uint32_t columnDefs = static_cast<uint32_t>(to.columnDefs.name.size());
+    uint32_t inserts = static_cast<uint32_t>(to.inserts.table.size());
+    uint32_t selects = static_cast<uint32_t>(to.selects.table.size());
+    uint32_t names = static_cast<uint32_t>(to.names.size());
+    uint32_t values = static_cast<uint32_t>(to.values.kind.size());
+
+    size_t offset = count ? tokens[0].offset : 0;
+    for (size_t i = 0; i < from.size(); i++) {
+        StatementKind k = from.statements.kind[i];
+        uint32_t base = k == StatementKind::CreateTable ? createTables
+                      : k == StatementKind::Insert      ? inserts
+                                                        : selects;
+        to.statements.kind.push_back(k);
+        to.statements.row.push_back(from.statements.row[i] + base);
+        to.statements.offset.push_back(offset);
+    }
+    append(to.createTables.table, from.createTables.table, same);
+    append(to.createTables.firstColumn, from.createTables.firstColumn, shift(columnDefs));
+    append(to.createTables.columnCount, from.createTables.columnCount, same);
+    append(to.createTables.primaryKey, from.createTables.primaryKey, same);
+    append(to.createTables.repeatedKey, from.createTables.repeatedKey, same);
+    append(to.columnDefs.name, from.columnDefs.name, same);
+    append(to.columnDefs.type, from.columnDefs.type, same);
+    append(to.inserts.table, from.inserts.table, same);
+    append(to.inserts.firstColumn, from.inserts.firstColumn, shift(names));
+    append(to.inserts.columnCount, from.inserts.columnCount, same);
+    append(to.inserts.firstValue, from.inserts.firstValue, shift(values));
+    append(to.inserts.valueCount, from.inserts.valueCount, same);
+    append(to.selects.table, from.selects.table, same);
+    append(to.selects.firstColumn, from.selects.firstColumn, shift(names));
+    append(to.selects.columnCount, from.selects.columnCount, same);
+    append(to.selects.condition, from.selects.condition, same);
+    append(to.selects.conditionColumn, from.selects.conditionColumn, same);
+    append(to.selects.firstValue, from.selects.firstValue, shift(values));
+    append(to.selects.valueCount, from.selects.valueCount, same);
+    append(to.names, from.names, same);
+
+    // Values: literals come from the tokens, identifiers from `from`.
+    size_t t = 0;
+    for (size_t v = 0; v < from.values.kind.size(); v++) {
+        ValueKind k = from.values.kind[v];
+        to.values.kind.push_back(k);
+        if (k == ValueKind::Identifier) {
+            to.values.text.push_back(NO_TEXT);
+            to.values.symbol.push_back(from.values.symbol[v]);
+            continue;
+        }
+        while (t < count && tokens[t].type != TokenType::NUMBER && tokens[t].type != TokenType::STRING)
+            t++;
+        Token literal = t < count ? tokens[t++] : Token();
+        to.values.text.push_back({static_cast<uint32_t>(to.text.size()),
+                                  static_cast<uint32_t>(literal.lexeme.size())});
+        to.text.append(literal.lexeme);
+        to.values.symbol.push_back(literal.symbol);
+    }
+}
+
+static void printValue(ostream &out, const Ast &ast, uint32_t v) {
+    if (ast.values.kind[v] == ValueKind::Identifier) {
+        out << symbolText(ast.values.symbol[v]);
+        return;
+    }
+    string_view text = ast.str(ast.values.text[v]);
+    if (ast.values.kind[v] != ValueKind::String) {
+        out << text;
+        return;
+    }
+    out << '\'';
+    for (char c : text) {
+        if (c == '\'')
+            out << '\'';
+        out << c;
+    }
+    out << '\'';
+}
+
+static void printValueList(ostream &out, const Ast &ast, uint32_t first, uint32_t count) {
+    for (uint32_t v = first; v < first + count; v++) {
+        if (v > first)
+            out << ", ";
+        printValue(out, ast, v);
+    }
+}
+
+static void printNameList(ostream &out, const Ast &ast, uint32_t first, uint32_t count) {
+    for (uint32_t n = first; n < first + count; n++)
+        out << (n > first ? ", " : "") << symbolText(ast.names[n]);
+}
+
+void printAst(ostream &out, const Ast &ast) {
+    for (size_t i = 0; i < ast.size(); i++) {
+        uint32_t r = ast.statements.row[i];
+        switch (ast.statements.kind[i]) {
+            case StatementKind::CreateTable: {
+                const auto &c = ast.createTables;
+                out << "CREATE TABLE " << symbolText(c.table[r]) << " (";
+                for (uint32_t d = c.firstColumn[r]; d < c.firstColumn[r] + c.columnCount[r]; d++) {
+                    out << (d > c.firstColumn[r] ? ", " : "") << symbolText(ast.columnDefs.name[d]) << " "
+                        << symbolText(ast.columnDefs.type[d]);
+                }
+                if (c.primaryKey[r] != NO_SYMBOL)
+                    out << (c.columnCount[r] ? ", " : "") << "PRIMARY KEY (" << symbolText(c.primaryKey[r]) << ")";
+                if (c.repeatedKey[r] != NO_SYMBOL)
+                    out << ", PRIMARY KEY (" << symbolText(c.repeatedKey[r]) << ")";
+                out << ");\n";
+                break;
+            }
+            case StatementKind::Insert: {
+                const auto &in = ast.inserts;
+                out << "INSERT INTO " << symbolText(in.table[r]);
+                if (in.columnCount[r]) {
+                    out << " (";
+                    printNameList(out, ast, in.firstColumn[r], in.columnCount[r]);
+                    out << ")";
+                }
+                out << " VALUES (";
+                printValueList(out, ast, in.firstValue[r], in.valueCount[r]);
+                out << ");\n";
+                break;
+            }
+            case StatementKind::Select: {
+                const auto &s = ast.selects;
+                out << "SELECT ";
+                if (s.columnCount[r])
+                    printNameList(out, ast, s.firstColumn[r], s.columnCount[r]);
+                else
+                    out << "*";
+                out << " FROM " << symbolText(s.table[r]);
+                uint32_t v = s.firstValue[r];
+                switch (s.condition[r]) {
+                    case ConditionKind::None: break;
+                    case ConditionKind::Equal:
+                    case ConditionKind::Greater:
+                    case ConditionKind::Less:
+                        out << " WHERE " << symbolText(s.conditionColumn[r]) << " "
+                            << (s.condition[r] == ConditionKind::Equal ? "=" :
+                                s.condition[r] == ConditionKind::Greater ? ">" : "<") << " ";
+                        printValue(out, ast, v);
+                        break;
+                    case ConditionKind::Between:
+                        out << " WHERE " << symbolText(s.conditionColumn[r]) << " BETWEEN ";
+                        printValue(out, ast, v);
+                        out << " AND ";
+                        printValue(out, ast, v + 1);
+                        break;
+                    case ConditionKind::Like:
+                        out << " WHERE " << symbolText(s.conditionColumn[r]) << " LIKE ";
+                        printValue(out, ast, v);
+                        break;
+                    case ConditionKind::In:
+                        out << " WHERE " << symbolText(s.conditionColumn[r]) << " IN (";
+                        printValueList(out, ast, v, s.valueCount[r]);
+                        out << ")";
+                        break;
+                }
+                out << ";\n";
+                break;
+            }
+        }
+    }
+}
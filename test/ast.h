@@ -0,0 +1,149 @@
+#ifndef AST_H
+#define AST_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lalr.h"
+#include "ll1_table.h"
+#include "symbols.h"
+#include "token.h"
+using namespace std;
+
+// Typed AST for CREATE TABLE, INSERT and SELECT, in structure-of-arrays
+// layout: one table per kind of item, one vector per field, and lists
+// stored as (first, count) ranges into a shared table. Names (tables,
+// columns, types) are symbol IDs from the process-wide pool (symbols.h),
+// compared as integers; literals are copied into the Ast's own text
+// buffer. So an Ast does not point into the input and moving it to
+// another thread moves a few vectors.
+
+// A piece of Ast::text.
+struct TextRef {
+    uint32_t offset;
+    uint32_t length;
+};
+const TextRef NO_TEXT = {UINT32_MAX, 0};
+
+enum class StatementKind : uint8_t { CreateTable, Insert, Select };
+enum class ValueKind : uint8_t { Number, String, Identifier };
+enum class ConditionKind : uint8_t { None, Equal, Greater, Less, Between, Like, In };
+
+struct Ast {
+    string text;
+
+    // Statements in source order. `row` indexes the table for `kind`.
+    struct Statements {
+        vector<StatementKind> kind;
+        vector<uint32_t> row;
+        vector<size_t> offset;      // Byte offset of the first token.
+    } statements;
+
+    struct CreateTables {
+        vector<uint32_t> table;
+        vector<uint32_t> firstColumn;   // Into columnDefs.
+        vector<uint32_t> columnCount;
+        vector<uint32_t> primaryKey;    // NO_SYMBOL without PRIMARY KEY (...).
+        vector<uint32_t> repeatedKey;   // The key of a second PRIMARY KEY (...), an error; else NO_SYMBOL.
+    } createTables;
+
+    struct ColumnDefs {
+        vector<uint32_t> name;
+        vector<uint32_t> type;
+    } columnDefs;
+
+    struct Inserts {
+        vector<uint32_t> table;
+        vector<uint32_t> firstColumn;   // Into names; columnCount 0 without a column list.
+        vector<uint32_t> columnCount;
+        vector<uint32_t> firstValue;    // Into values.
+        vector<uint32_t> valueCount;
+    } inserts;
+
+    struct Selects {
+        vector<uint32_t> table;
+        vector<uint32_t> firstColumn;   // Into names; columnCount 0 for '*'.
+        vector<uint32_t> columnCount;
+        vector<ConditionKind> condition;
+        vector<uint32_t> conditionColumn; // NO_SYMBOL without WHERE.
+        vector<uint32_t> firstValue;    // Comparison and LIKE: 1 value, BETWEEN: 2, IN: the list.
+        vector<uint32_t> valueCount;
+    } selects;
+
+    // Column name lists of INSERT and SELECT.
+    vector<uint32_t> names;
+
+    // Literals (and identifiers used as values), numbered in source order:
+    // the index is the literal's slot, so later stages can refer to a
+    // literal, or bind a different one, without touching the statement.
+    struct Values {
+        vector<ValueKind> kind;
+        vector<TextRef> text;       // Literals; NO_TEXT for identifiers.
+        // Identifiers; literals too if the lexer interned them, else NO_SYMBOL.
+        vector<uint32_t> symbol;
+    } values;
+
+    size_t size() const { return statements.kind.size(); }
+    string_view str(TextRef r) const { return string_view(text).substr(r.offset, r.length); }
+    // Empties the Ast; its vectors keep their capacity.
+    void clear();
+};
+
+// Fills an Ast from the tokens the parser matches. The builder only looks
+// at the token sequence; it relies on the parser to reject anything the
+// grammar does not allow, so it is cheap enough to run on every token.
+class AstBuilder {
+public:
+    explicit AstBuilder(Ast &ast);
+
+    // Called for each matched token, in order. A ';' completes the
+    // current statement.
+    void token(const Token &tok);
+    // Drops the statement in progress, after a syntax error.
+    void rollback();
+
+private:
+    enum class State : uint8_t {
+        Start, TableName, ColumnName, ColumnType, PrimaryKey,
+        InsertColumns, Values, Projection, ConditionColumn, Condition
+    };
+    // Sizes of the tables when the last statement completed.
+    struct Mark {
+        size_t text, statements, createTables, columnDefs, inserts, selects, names, values;
+    };
+
+    TextRef addText(string_view s);
+    static uint32_t symbolOf(const Token &tok);
+    void addValue(const Token &tok);
+    void setCondition(ConditionKind k);
+    void beginStatement(StatementKind kind, const Token &tok);
+    Mark currentMark() const;
+
+    Ast &ast;
+    State state = State::Start;
+    StatementKind kind = StatementKind::Select;
+    Mark mark;
+};
+
+// ll1Check() that also appends each statement it accepts to `ast`. On a
+// syntax error the statements before the failing one are kept.
+bool ll1Build(const Token *tokens, size_t count, const LL1Table &table,
+              vector<uint16_t> &stack, string &error, Ast &ast);
+
+// The same with the LALR(1) engine; the builder sees the shifted tokens.
+bool lalrBuild(const Token *tokens, size_t count, const LALRTable &table,
+               vector<uint16_t> &stack, string &error, Ast &ast);
+
+// Appends the statements of `from` to `to`, except that the Number and
+// String values of `from` take the lexemes (and symbols) of the NUMBER and
+// STRING tokens of tokens[0, count), in order, and the statements take the
+// offset of tokens[0]. This binds a cached statement (see ParseCache) to a
+// statement of the same shape.
+void appendStatement(Ast &to, const Ast &from, const Token *tokens, size_t count);
+
+// Prints each statement on one line as normalized SQL.
+void printAst(ostream &out, const Ast &ast);
+
+#endif // AST_H
@@ -0,0 +1,945 @@
+// Micro-benchmarks for the SQL compiler pipeline.
+// Usage: ./sql_bench lexer [MB]
+//        ./sql_bench input [FILE | MB]
+//        ./sql_bench tree [MB]
+//        ./sql_bench sets [PRODUCTIONS]
+//        ./sql_bench tables [GRAMMAR]
+//        ./sql_bench engines [MB]
+//        ./sql_bench rd [MB]
+//        ./sql_bench fused [MB]
+//        ./sql_bench api [MB]
+//        ./sql_bench intern [MB]
+//        ./sql_bench lookup [ROWS]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "catalog.h"
+#include "grammar.h"
+#include "input.h"
+#include "lalr.h"
+#include "lexer.h"
+#include "ll1_table.h"
+#include "parse_tree.h"
+#include "parallel.h"
+#include "parser_api.h"
+#include "parser.h"
+#include "rd_parser.h"
+#include "scan.h"
+#include "semantic.h"
+#include "store.h"
+#include "symbols.h"
+#include "table_cache.h"
+#include "token.h"
+#include "token_ring.h"
+#include "utils.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+// Heap allocation counters (the benchmarks are single-threaded).
+static size_t allocCount = 0;
+static size_t allocBytes = 0;
+
+void *operator new(size_t n) {
+    allocCount++;
+    allocBytes += n;
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { free(p); }
+
+static double secondsSince(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Builds a script of roughly `bytes` bytes from the statement shapes the
+// grammar accepts, with enough long identifiers, literals and whitespace
+// runs to exercise every scanner.
+static string makeSyntheticScript(size_t bytes, unsigned seed) {
+    mt19937 rng(seed);
+    string out;
+    out.reserve(bytes + 256);
+    out += "CREATE TABLE customer_accounts (account_identifier INT, display_name VARCHAR, "
+           "balance DECIMAL, PRIMARY KEY (account_identifier));\n";
+    while (out.size() < bytes) {
+        switch (rng() % 4) {
+            case 0:
+            case 1:
+                out += "INSERT INTO customer_accounts (account_identifier, display_name, balance)\n"
+                       "    VALUES (";
+                out += to_string(rng() % 100000000);
+                out += ", 'Customer number ";
+                out += to_string(rng());
+                out += " of the northern region', ";
+                out += to_string(rng() % 100000) + "." + to_string(rng() % 100);
+                out += ");\n";
+                break;
+            case 2:
+                out += "SELECT account_identifier, display_name FROM customer_accounts "
+                       "WHERE balance BETWEEN 100 AND ";
+                out += to_string(rng() % 100000);
+                out += ";\n";
+                break;
+            default:
+                out += "SELECT * FROM customer_accounts WHERE account_identifier IN (";
+                for (int i = 0; i < 16; i++) {
+                    if (i) out += ", ";
+                    out += to_string(rng() % 100000000);
+                }
+                out += ");\n\n\t\t";
+                break;
+        }
+    }
+    return out;
+}
+
+static bool sameTokens(const vector<Token> &a, const vector<Token> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].lexeme != b[i].lexeme || a[i].offset != b[i].offset)
+            return false;
+    }
+    return true;
+}
+
+// Lexer throughput for every scan mode the CPU supports. The scalar mode is
+// the byte-at-a-time baseline the vector modes are compared against.
+static int benchLexer(size_t megabytes) {
+    string script = makeSyntheticScript(megabytes << 20, 42);
+    cout << "Input: " << script.size() << " bytes" << endl;
+
+    vector<Token> reference;
+    double baseline = 0;
+    for (ScanMode mode : {ScanMode::Scalar, ScanMode::SSE2, ScanMode::AVX2}) {
+        if (!setScanMode(mode)) {
+            cout << scanModeName(mode) << "\tnot supported on this CPU" << endl;
+            continue;
+        }
+        const int reps = 5;
+        double best = 1e30;
+        vector<Token> tokens;
+        for (int r = 0; r < reps; r++) {
+            Lexer lexer(script);
+            Clock::time_point start = Clock::now();
+            tokens = lexer.tokenize();
+            best = min(best, secondsSince(start));
+        }
+        if (mode == ScanMode::Scalar) {
+            reference = tokens;
+            baseline = best;
+        } else if (!sameTokens(reference, tokens)) {
+            cerr << "Error: " << scanModeName(mode) << " tokens differ from the scalar lexer" << endl;
+            return 1;
+        }
+        double mbps = script.size() / best / 1e6;
+        cout << scanModeName(mode) << "\t" << tokens.size() << " tokens\t" << mbps << " MB/s\t"
+             << "x" << baseline / best << endl;
+    }
+    setScanMode(bestScanMode());
+    return 0;
+}
+
+// Lexes `input` token by token; returns the token count and records the
+// time at which the first token was available.
+static size_t lexAll(string_view input, Clock::time_point start, double &firstToken) {
+    Lexer lexer(input);
+    Token tok = lexer.nextToken();
+    firstToken = secondsSince(start);
+    size_t count = 1;
+    while (tok.type != TokenType::END) {
+        tok = lexer.nextToken();
+        count++;
+    }
+    return count;
+}
+
+// Time to first token and lexing throughput for the interactive path
+// (getline into one string, as main() does for stdin) versus mapping the
+// file with InputFile. Both runs see a warm page cache.
+static int benchInput(const string &arg) {
+    string path = arg;
+    if (arg.empty() || arg.find_first_not_of("0123456789") == string::npos) {
+        size_t megabytes = arg.empty() ? 256 : strtoul(arg.c_str(), nullptr, 10);
+        path = "/tmp/sql_bench_input.sql";
+        ofstream(path) << makeSyntheticScript(megabytes << 20, 7);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        bool report = pass == 1;  // The first pass only warms the page cache.
+
+        Clock::time_point start = Clock::now();
+        ifstream in(path);
+        string input, line;
+        while (getline(in, line))
+            input += line + "\n";
+        double first;
+        size_t tokens = lexAll(input, start, first);
+        double total = secondsSince(start);
+        if (report)
+            cout << "getline\tfirst token " << first * 1e3 << " ms\t" << tokens << " tokens\t"
+                 << input.size() / total / 1e6 << " MB/s" << endl;
+
+        start = Clock::now();
+        InputFile file;
+        if (!file.open(path))
+            return 1;
+        tokens = lexAll(file.data(), start, first);
+        total = secondsSince(start);
+        if (report)
+            cout << (file.isMapped() ? "mmap" : "read") << "\tfirst token " << first * 1e3 << " ms\t"
+                 << tokens << " tokens\t" << file.data().size() / total / 1e6 << " MB/s" << endl;
+    }
+    return 0;
+}
+
+// The parse tree design that parse_tree.h used to sketch: one make_shared
+// node per symbol, copied symbol and lexeme strings, parallel symbol and
+// node stacks, and lookups in the map-based parsing table. Kept only as the
+// baseline for the tree benchmark.
+struct LegacyTreeNode {
+    string symbol;
+    string lexeme;
+    vector<shared_ptr<LegacyTreeNode>> children;
+
+    LegacyTreeNode(const string &sym) : symbol(sym), lexeme("") {}
+};
+
+static shared_ptr<LegacyTreeNode> legacyParseWithTree(
+    const Token *tokens, size_t count, const vector<Production> &grammar,
+    const map<pair<string, string>, vector<int>> &parsingTable) {
+    vector<string> symbolStack;
+    vector<shared_ptr<LegacyTreeNode>> nodeStack;
+    auto rootNode = make_shared<LegacyTreeNode>("<sql>");
+    symbolStack.push_back("$");
+    symbolStack.push_back("<sql>");
+    nodeStack.push_back(nullptr);
+    nodeStack.push_back(rootNode);
+
+    size_t i = 0;
+    while (!symbolStack.empty()) {
+        string top = symbolStack.back();
+        auto topNode = nodeStack.back();
+        string inputSymbol = i < count ? terminalForToken(tokens[i].type) : "$";
+        string inputLexeme = i < count ? string(tokens[i].lexeme) : "";
+        if (top == "$" || !isNonTerminal(top)) {
+            if (top != inputSymbol)
+                return nullptr;
+            if (topNode)
+                topNode->lexeme = inputLexeme;
+            symbolStack.pop_back();
+            nodeStack.pop_back();
+            i++;
+        } else {
+            pair<string, string> key = {top, inputSymbol};
+            if (parsingTable.find(key) == parsingTable.end())
+                return nullptr;
+            vector<int> prodIndices = parsingTable.at(key);
+            if (prodIndices.size() != 1)
+                return nullptr;
+            Production prod = grammar[prodIndices[0]];
+            symbolStack.pop_back();
+            nodeStack.pop_back();
+            if (!(prod.rhs.size() == 1 && prod.rhs[0] == EPSILON)) {
+                vector<shared_ptr<LegacyTreeNode>> newChildren;
+                for (int j = static_cast<int>(prod.rhs.size()) - 1; j >= 0; j--) {
+                    auto childNode = make_shared<LegacyTreeNode>(prod.rhs[j]);
+                    newChildren.insert(newChildren.begin(), childNode);
+                    symbolStack.push_back(prod.rhs[j]);
+                    nodeStack.push_back(childNode);
+                }
+                for (const auto &child : newChildren)
+                    topNode->children.push_back(child);
+            } else {
+                topNode->children.push_back(make_shared<LegacyTreeNode>("ε"));
+            }
+        }
+    }
+    return rootNode;
+}
+
+static size_t countLegacyNodes(const LegacyTreeNode &node) {
+    size_t n = 1;
+    for (const auto &c : node.children)
+        n += countLegacyNodes(*c);
+    return n;
+}
+
+// Nodes as the legacy tree counts them, with an "ε" node per epsilon
+// expansion.
+static size_t countArenaNodes(const ParseArena &arena, const LL1Table &table) {
+    size_t n = arena.size();
+    for (uint32_t i = 0; i < arena.size(); i++) {
+        if (!table.isTerminal(arena[i].symbol) && arena[i].childCount == 0)
+            n++;
+    }
+    return n;
+}
+
+// First token of each statement, then the END token.
+static vector<size_t> statementStarts(const vector<Token> &tokens) {
+    vector<size_t> starts = {0};
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (tokens[i].type == TokenType::SEMICOLON && i + 1 < tokens.size() &&
+            tokens[i + 1].type != TokenType::END)
+            starts.push_back(i + 1);
+    }
+    starts.push_back(tokens.size() - 1);
+    return starts;
+}
+
+// Builds a parse tree per statement, in batches of `batchSize` statements:
+// the arena is reset per batch, the legacy trees of a batch are kept alive
+// until the batch ends. Reports time, heap traffic and tree memory.
+static int benchTree(size_t megabytes) {
+    const size_t batchSize = 1024;
+    string script = makeSyntheticScript(megabytes << 20, 42);
+    Lexer lexer(script);
+    vector<Token> tokens = lexer.tokenize();
+    vector<size_t> starts = statementStarts(tokens);
+    size_t statements = starts.size() - 1;
+    cout << "Input: " << script.size() << " bytes, " << statements << " statements, batches of "
+         << batchSize << endl;
+
+    vector<Production> grammar = buildGrammar();
+    GrammarSets sets = computeGrammarSets(grammar);
+    auto first = firstSetsAsMap(sets);
+    auto follow = followSetsAsMap(sets);
+    auto parsingTable = constructParsingTable(grammar, first, follow);
+    const LL1Table &table = builtinLL1Table;
+
+    // Arena trees.
+    ParseArena arena;
+    vector<uint32_t> stack;
+    string error;
+    size_t nodes = 0, peakBytes = 0;
+    size_t allocs0 = allocCount, bytes0 = allocBytes;
+    Clock::time_point start = Clock::now();
+    for (size_t b = 0; b < statements; b += batchSize) {
+        arena.reset();
+        for (size_t s = b; s < min(statements, b + batchSize); s++) {
+            if (ll1ParseTree(&tokens[starts[s]], starts[s + 1] - starts[s], table, arena, stack, error) < 0) {
+                cerr << "Error: statement " << s << ": " << error << endl;
+                return 1;
+            }
+        }
+        nodes += countArenaNodes(arena, table);
+        peakBytes = max(peakBytes, arena.bytesReserved());
+    }
+    double arenaTime = secondsSince(start);
+    size_t arenaAllocs = allocCount - allocs0, arenaBytes = allocBytes - bytes0;
+
+    // shared_ptr trees.
+    vector<shared_ptr<LegacyTreeNode>> roots;
+    size_t legacyNodes = 0, legacyPeak = 0;
+    allocs0 = allocCount;
+    bytes0 = allocBytes;
+    start = Clock::now();
+    for (size_t b = 0; b < statements; b += batchSize) {
+        roots.clear();
+        size_t batchBytes0 = allocBytes;
+        for (size_t s = b; s < min(statements, b + batchSize); s++) {
+            roots.push_back(legacyParseWithTree(&tokens[starts[s]], starts[s + 1] - starts[s],
+                                                grammar, parsingTable));
+            if (!roots.back()) {
+                cerr << "Error: statement " << s << " rejected by the legacy parser" << endl;
+                return 1;
+            }
+            legacyNodes += countLegacyNodes(*roots.back());
+        }
+        legacyPeak = max(legacyPeak, allocBytes - batchBytes0);
+    }
+    roots.clear();
+    double legacyTime = secondsSince(start);
+    size_t legacyAllocs = allocCount - allocs0, legacyBytes = allocBytes - bytes0;
+
+    if (nodes != legacyNodes) {
+        cerr << "Error: arena trees have " << nodes << " nodes, shared_ptr trees " << legacyNodes << endl;
+        return 1;
+    }
+    cout << "arena\t" << nodes << " nodes\t" << statements / arenaTime / 1e6 << " M stmts/s\t"
+         << arenaAllocs << " allocs\t" << arenaBytes << " bytes allocated\t"
+         << peakBytes << " bytes per batch" << endl;
+    cout << "shared_ptr\t" << legacyNodes << " nodes\t" << statements / legacyTime / 1e6 << " M stmts/s\t"
+         << legacyAllocs << " allocs\t" << legacyBytes << " bytes allocated\t"
+         << legacyPeak << " bytes per batch" << endl;
+    cout << "speedup x" << legacyTime / arenaTime << endl;
+    return 0;
+}
+
+// A random grammar with about `productions` rules over productions/3
+// nonterminals and 512 terminals. RHS symbols mostly refer to later
+// nonterminals, giving long dependency chains, with some references back
+// to earlier ones for cycles; about one rule in ten is an epsilon rule.
+static vector<Production> makeSyntheticGrammar(size_t productions, unsigned seed) {
+    mt19937 rng(seed);
+    size_t nonTerminals = max<size_t>(productions / 3, 1);
+    auto nonTerminal = [](size_t i) { return "<n" + to_string(i) + ">"; };
+    vector<Production> grammar;
+    for (size_t n = 0; n < nonTerminals; n++) {
+        for (int r = 0; r < 3; r++) {
+            Production prod{nonTerminal(n), {}};
+            if (rng() % 10 == 0) {
+                prod.rhs.push_back(EPSILON);
+            } else {
+                size_t len = 1 + rng() % 4;
+                for (size_t k = 0; k < len; k++) {
+                    unsigned pick = rng() % 10;
+                    if (pick < 5 && n + 1 < nonTerminals)
+                        prod.rhs.push_back(nonTerminal(n + 1 + rng() % min<size_t>(64, nonTerminals - n - 1)));
+                    else if (pick < 6)
+                        prod.rhs.push_back(nonTerminal(rng() % nonTerminals));
+                    else
+                        prod.rhs.push_back("t" + to_string(rng() % 512));
+                }
+            }
+            grammar.push_back(prod);
+        }
+    }
+    return grammar;
+}
+
+// FIRST/FOLLOW on synthetic grammars of a sixteenth of `maxProductions`
+// rules, doubling up to `maxProductions`: the bitset worklist version
+// against the original fixed-point loops, which must agree.
+static int benchSets(size_t maxProductions) {
+    for (size_t productions = max<size_t>(maxProductions >> 4, 1); productions <= maxProductions; productions *= 2) {
+        vector<Production> grammar = makeSyntheticGrammar(productions, 11);
+
+        Clock::time_point start = Clock::now();
+        GrammarSets sets = computeGrammarSets(grammar);
+        double bitsetTime = secondsSince(start);
+
+        start = Clock::now();
+        auto first = computeFirstSetsFixedPoint(grammar);
+        auto follow = computeFollowSetsFixedPoint(grammar, first);
+        double fixedTime = secondsSince(start);
+
+        if (first != firstSetsAsMap(sets) || follow != followSetsAsMap(sets)) {
+            cerr << "Error: FIRST/FOLLOW sets differ for " << grammar.size() << " productions" << endl;
+            return 1;
+        }
+        cout << grammar.size() << " productions\t" << sets.symbols.size() << " symbols\t"
+             << "worklist " << bitsetTime * 1e3 << " ms\tfixed point " << fixedTime * 1e3 << " ms\t"
+             << "x" << fixedTime / bitsetTime << endl;
+    }
+    return 0;
+}
+
+// Average time of a parsing table lookup, over random (nonterminal,
+// terminal) pairs, in the map, a dense array and the compressed table.
+static void benchTableLookups(const LL1Table &t, const map<pair<string, string>, vector<int>> &parsingTable) {
+    size_t rows = t.numSymbols - t.numTerminals;
+    vector<int16_t> dense(rows * t.numTerminals);
+    for (uint16_t nt = t.numTerminals; nt < t.numSymbols; nt++) {
+        for (uint16_t term = 0; term < t.numTerminals; term++)
+            dense[(nt - t.numTerminals) * t.numTerminals + term] = t.cell(nt, term);
+    }
+    const size_t lookups = 1 << 22;
+    mt19937 rng(1);
+    vector<pair<uint16_t, uint16_t>> keys(4096);
+    vector<pair<string, string>> names(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i] = {static_cast<uint16_t>(t.numTerminals + rng() % rows), static_cast<uint16_t>(rng() % t.numTerminals)};
+        names[i] = {t.symbolNames[keys[i].first], t.symbolNames[keys[i].second]};
+    }
+    volatile long sink = 0;   // Keeps the lookups from being optimized away.
+    auto time = [&](auto lookup, size_t n) {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < n; i++)
+            sink = sink + lookup(i % keys.size());
+        return secondsSince(start) * 1e9 / n;
+    };
+    double compressedNs = time([&](size_t k) { return t.cell(keys[k].first, keys[k].second); }, lookups);
+    double denseNs = time([&](size_t k) {
+        return dense[(keys[k].first - t.numTerminals) * t.numTerminals + keys[k].second];
+    }, lookups);
+    double mapNs = time([&](size_t k) {
+        auto it = parsingTable.find(names[k]);
+        return it == parsingTable.end() ? -1 : it->second.front();
+    }, lookups / 16);
+    cout << "lookup\tmap " << mapNs << " ns\tdense " << denseNs << " ns\tcompressed " << compressedNs << " ns" << endl;
+}
+
+// Startup cost of getting LL(1) tables for a grammar file: full analysis
+// (read, FIRST/FOLLOW, parsing table, compile) against mapping the cached
+// table file. Best of several runs each. Also times a table lookup.
+static int benchTables(const string &grammarPath) {
+    const int reps = 20;
+    double compileTime = 1e30, loadTime = 1e30;
+    uint64_t hash = 0;
+    string cachePath = "/tmp/sql_bench_tables.ll1";
+    for (int r = 0; r < reps; r++) {
+        Clock::time_point start = Clock::now();
+        vector<Production> grammar;
+        if (!readCFGGrammarFile(grammarPath, grammar))
+            return 1;
+        GrammarSets sets = computeGrammarSets(grammar);
+        auto first = firstSetsAsMap(sets);
+        auto follow = followSetsAsMap(sets);
+        auto parsingTable = constructParsingTable(grammar, first, follow);
+        LL1TableData data = compileLL1Table(grammar, parsingTable);
+        compileTime = min(compileTime, secondsSince(start));
+        hash = grammarHash(grammar);
+        if (r == 0) {
+            LL1Table t = data.view();
+            cout << "table\t" << static_cast<size_t>(t.numSymbols - t.numTerminals) * t.numTerminals * sizeof(int16_t)
+                 << " bytes dense\t" << t.tableBytes() << " bytes compressed" << endl;
+            benchTableLookups(t, parsingTable);
+            if (!writeLL1TableFile(cachePath, t, hash))
+                return 1;
+        }
+    }
+    for (int r = 0; r < reps; r++) {
+        Clock::time_point start = Clock::now();
+        LL1TableFile file;
+        if (!file.open(cachePath, hash)) {
+            cerr << "Error: Unable to load " << cachePath << endl;
+            return 1;
+        }
+        loadTime = min(loadTime, secondsSince(start));
+    }
+    cout << "analysis\t" << compileTime * 1e6 << " us" << endl;
+    cout << "cached\t" << loadTime * 1e6 << " us\tx" << compileTime / loadTime << endl;
+    return 0;
+}
+
+// Checks the same script with ll1Check() and lalrCheck(), statement by
+// statement and then as one token stream. Reports tokens/s and the deepest
+// stack each engine reached. Best of several runs.
+static int benchEngines(size_t megabytes) {
+    const int reps = 3;
+    string script = makeSyntheticScript(megabytes << 20, 42);
+    Lexer lexer(script);
+    vector<Token> tokens = lexer.tokenize();
+    vector<size_t> starts = statementStarts(tokens);
+    size_t statements = starts.size() - 1;
+    cout << "Input: " << script.size() << " bytes, " << tokens.size() << " tokens, "
+         << statements << " statements" << endl;
+
+    LALRTableData lalrData = compileLALRTable(buildGrammar());
+    if (!lalrData.conflicts.empty()) {
+        cerr << "Error: " << lalrData.conflicts.front() << endl;
+        return 1;
+    }
+    LALRTable lalr = lalrData.view();
+    const LL1Table &ll1 = builtinLL1Table;
+    cout << "LALR(1): " << lalr.numStates << " states" << endl;
+
+    vector<uint16_t> stack;
+    string error;
+    for (bool whole : {false, true}) {
+        // Ranges of tokens checked as one parse.
+        vector<pair<size_t, size_t>> ranges;
+        if (whole)
+            ranges.push_back({0, tokens.size() - 1});
+        else
+            for (size_t s = 0; s < statements; s++)
+                ranges.push_back({starts[s], starts[s + 1] - starts[s]});
+
+        double ll1Time = 1e30, lalrTime = 1e30;
+        size_t ll1Peak = 0, lalrPeak = 0;
+        for (int r = 0; r < reps; r++) {
+            Clock::time_point start = Clock::now();
+            for (const auto &range : ranges) {
+                // The stack holds the symbols below the one being expanded.
+                if (!ll1Run(&tokens[range.first], range.second, ll1, stack, error,
+                            [&](const Token &) { ll1Peak = max(ll1Peak, stack.size() + 1); })) {
+                    cerr << "Error: LL(1): " << error << endl;
+                    return 1;
+                }
+            }
+            ll1Time = min(ll1Time, secondsSince(start));
+
+            start = Clock::now();
+            for (const auto &range : ranges) {
+                size_t peak = 0;
+                if (!lalrRun(&tokens[range.first], range.second, lalr, stack, error,
+                             [](const Token &) {}, &peak)) {
+                    cerr << "Error: LALR(1): " << error << endl;
+                    return 1;
+                }
+                lalrPeak = max(lalrPeak, peak);
+            }
+            lalrTime = min(lalrTime, secondsSince(start));
+        }
+        const char *label = whole ? "script" : "per statement";
+        cout << label << "\tll1\t" << tokens.size() / ll1Time / 1e6 << " M tokens/s\tpeak stack "
+             << ll1Peak << endl;
+        cout << label << "\tlalr\t" << tokens.size() / lalrTime / 1e6 << " M tokens/s\tpeak stack "
+             << lalrPeak << endl;
+    }
+    return 0;
+}
+
+// Checks that the generated recursive-descent parser agrees with ll1Check()
+// (result and message) on every statement of a synthetic script, on a
+// mutated copy of each statement (a token deleted, duplicated or replaced),
+// and on the whole script; then times both on the valid statements.
+static int benchRD(size_t megabytes) {
+    const int reps = 3;
+    string script = makeSyntheticScript(megabytes << 20, 42);
+    Lexer lexer(script);
+    vector<Token> tokens = lexer.tokenize();
+    vector<size_t> starts = statementStarts(tokens);
+    size_t statements = starts.size() - 1;
+    cout << "Input: " << script.size() << " bytes, " << tokens.size() << " tokens, "
+         << statements << " statements" << endl;
+
+    const LL1Table &table = builtinLL1Table;
+    vector<uint16_t> stack;
+    string ll1Error, rdError;
+    size_t checked = 0, rejected = 0;
+    auto agree = [&](const Token *t, size_t n) {
+        bool ll1 = ll1Check(t, n, table, stack, ll1Error);
+        bool rd = rdCheck(t, n, rdError);
+        checked++;
+        rejected += !ll1;
+        if (ll1 != rd || (!ll1 && ll1Error != rdError)) {
+            cerr << "Error: parsers disagree on input " << checked << ": ll1Check "
+                 << (ll1 ? "accepts" : ll1Error) << ", rdCheck " << (rd ? "accepts" : rdError) << endl;
+            return false;
+        }
+        return true;
+    };
+    mt19937 rng(7);
+    vector<Token> mutated;
+    for (size_t s = 0; s < statements; s++) {
+        const Token *t = &tokens[starts[s]];
+        size_t n = starts[s + 1] - starts[s];
+        if (!agree(t, n))
+            return 1;
+        mutated.assign(t, t + n);
+        size_t at = rng() % n;
+        switch (rng() % 3) {
+            case 0: mutated.erase(mutated.begin() + at); break;
+            case 1: mutated.insert(mutated.begin() + at, mutated[at]); break;
+            default: mutated[at] = tokens[rng() % tokens.size()]; break;
+        }
+        if (!agree(mutated.data(), mutated.size()))
+            return 1;
+    }
+    if (!agree(tokens.data(), tokens.size()))
+        return 1;
+    cout << "agree\t" << checked << " inputs, " << rejected << " rejected" << endl;
+
+    double ll1Time = 1e30, rdTime = 1e30;
+    for (int r = 0; r < reps; r++) {
+        Clock::time_point start = Clock::now();
+        for (size_t s = 0; s < statements; s++) {
+            if (!ll1Check(&tokens[starts[s]], starts[s + 1] - starts[s], table, stack, ll1Error))
+                return 1;
+        }
+        ll1Time = min(ll1Time, secondsSince(start));
+        start = Clock::now();
+        for (size_t s = 0; s < statements; s++) {
+            if (!rdCheck(&tokens[starts[s]], starts[s + 1] - starts[s], rdError))
+                return 1;
+        }
+        rdTime = min(rdTime, secondsSince(start));
+    }
+    cout << "ll1\t" << tokens.size() / ll1Time / 1e6 << " M tokens/s" << endl;
+    cout << "rd\t" << tokens.size() / rdTime / 1e6 << " M tokens/s\tx" << ll1Time / rdTime << endl;
+    return 0;
+}
+
+// Validates a script by tokenizing it first and then running ll1Check(),
+// and fused, with ll1Run() pulling tokens through a TokenRing. Reports time
+// and heap traffic of each, on the valid script and on a copy with a
+// syntax error in its second statement (time to first error).
+static int benchFused(size_t megabytes) {
+    string script = makeSyntheticScript(megabytes << 20, 42);
+    string broken = script;
+    broken.insert(broken.find(';') + 1, " SELECT FROM;");
+    cout << "Input: " << script.size() << " bytes" << endl;
+    const LL1Table &table = builtinLL1Table;
+
+    for (const string *input : {&script, &broken}) {
+        bool valid = input == &script;
+        vector<uint16_t> stack;
+        string error;
+
+        size_t allocs0 = allocCount, bytes0 = allocBytes;
+        Clock::time_point start = Clock::now();
+        size_t tokenBytes;
+        bool ok;
+        {
+            Lexer lexer(*input);
+            vector<Token> tokens = lexer.tokenize();
+            tokenBytes = tokens.capacity() * sizeof(Token);
+            ok = ll1Check(tokens.data(), tokens.size(), table, stack, error);
+        }
+        double batchTime = secondsSince(start);
+        size_t batchAllocs = allocCount - allocs0, batchBytes = allocBytes - bytes0;
+        if (ok != valid) {
+            cerr << "Error: tokenize + ll1Check: unexpected result " << error << endl;
+            return 1;
+        }
+
+        stack = vector<uint16_t>();
+        allocs0 = allocCount;
+        bytes0 = allocBytes;
+        start = Clock::now();
+        size_t consumed;
+        {
+            Lexer lexer(*input);
+            TokenRing<Lexer> ring(lexer);
+            ok = ll1Run(ring, table, stack, error, [](const Token &) {});
+            consumed = ring.consumed();
+        }
+        double fusedTime = secondsSince(start);
+        size_t fusedAllocs = allocCount - allocs0, fusedBytes = allocBytes - bytes0;
+        if (ok != valid) {
+            cerr << "Error: fused: unexpected result " << error << endl;
+            return 1;
+        }
+
+        const char *label = valid ? "valid" : "error";
+        cout << label << "\ttokenize+check\t" << batchTime * 1e3 << " ms\t" << batchAllocs << " allocs\t"
+             << batchBytes << " bytes allocated\t" << tokenBytes << " bytes of tokens" << endl;
+        cout << label << "\tfused\t" << fusedTime * 1e3 << " ms\t" << fusedAllocs << " allocs\t"
+             << fusedBytes << " bytes allocated\t" << consumed << " tokens consumed" << endl;
+    }
+    return 0;
+}
+
+// Parses a script one statement per call through the library API: with a
+// fresh ParseSession per call, and with one session reused for all of them
+// (cold, then warmed up), with and without building the AST. Reports calls
+// per second and heap allocations per call.
+static int benchApi(size_t megabytes) {
+    string script = makeSyntheticScript(megabytes << 20, 42);
+    vector<string_view> requests;
+    for (size_t begin = 0, end; (end = script.find(';', begin)) != string::npos; begin = end + 1)
+        requests.push_back(string_view(script).substr(begin, end + 1 - begin));
+    cout << "Input: " << requests.size() << " statements" << endl;
+    ParserContext context;
+
+    for (bool buildAst : {false, true}) {
+        ParseOptions options;
+        options.buildAst = buildAst;
+        const char *label = buildAst ? "ast" : "check";
+        auto report = [&](const char *how, size_t calls, size_t allocs, double seconds) {
+            cout << label << "\t" << how << "\t" << calls / seconds / 1e6 << " M calls/s\t"
+                 << static_cast<double>(allocs) / calls << " allocs/call" << endl;
+        };
+
+        size_t allocs0 = allocCount;
+        Clock::time_point start = Clock::now();
+        size_t rejected = 0;
+        for (string_view sql : requests) {
+            ParseSession session(context, options);
+            rejected += !session.parse(sql).ok();
+        }
+        report("fresh session", requests.size(), allocCount - allocs0, secondsSince(start));
+
+        ParseSession session(context, options);
+        for (const char *how : {"reused (cold)", "reused (warm)"}) {
+            allocs0 = allocCount;
+            start = Clock::now();
+            for (string_view sql : requests)
+                rejected += !session.parse(sql).ok();
+            report(how, requests.size(), allocCount - allocs0, secondsSince(start));
+        }
+        if (rejected) {
+            cerr << "Error: " << rejected << " statements rejected" << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Lexing with each Interning mode, and what interning buys later: finding
+// the distinct names and literals by symbol ID, as the symbol table does,
+// instead of by text in a hash map per kind, as it used to.
+static int benchIntern(size_t megabytes) {
+    string script = makeSyntheticScript(megabytes << 20, 42);
+    cout << "Input: " << script.size() << " bytes" << endl;
+    const int reps = 3;
+    vector<Token> tokens;
+    const pair<Interning, const char *> modes[] = {
+        {Interning::None, "none"}, {Interning::Identifiers, "identifiers"}, {Interning::All, "all"}};
+    for (const auto &mode : modes) {
+        double best = 1e30;
+        for (int r = 0; r < reps; r++) {
+            Lexer lexer(script);
+            lexer.setInterning(mode.first);
+            Clock::time_point start = Clock::now();
+            lexer.tokenize(tokens);
+            best = min(best, secondsSince(start));
+        }
+        cout << "lex, interning " << mode.second << "\t" << script.size() / best / 1e6 << " MB/s\t"
+             << symbolPool().size() << " symbols, " << symbolPool().textBytes() << " bytes in the pool" << endl;
+    }
+
+    size_t byText = 0, bySymbol = 0;
+    double textBest = 1e30, symbolBest = 1e30;
+    for (int r = 0; r < reps; r++) {
+        Clock::time_point start = Clock::now();
+        unordered_map<string_view, Token> identifiers, numbers, strings;
+        for (const auto &tok : tokens) {
+            if (tok.type == TokenType::IDENTIFIER)
+                identifiers[tok.lexeme] = tok;
+            else if (tok.type == TokenType::NUMBER)
+                numbers[tok.lexeme] = tok;
+            else if (tok.type == TokenType::STRING)
+                strings[tok.lexeme] = tok;
+        }
+        textBest = min(textBest, secondsSince(start));
+        byText = identifiers.size() + numbers.size() + strings.size();
+
+        start = Clock::now();
+        IdMap listed;
+        for (const auto &tok : tokens) {
+            if (tok.symbol != NO_SYMBOL)
+                listed.insert(tok.symbol, 0);
+        }
+        symbolBest = min(symbolBest, secondsSince(start));
+        bySymbol = listed.size();
+    }
+    cout << "distinct by text\t" << byText << "\t" << tokens.size() / textBest / 1e6 << " M tokens/s" << endl;
+    cout << "distinct by symbol\t" << bySymbol << "\t" << tokens.size() / symbolBest / 1e6 << " M tokens/s\tx"
+         << textBest / symbolBest << endl;
+    if (byText != bySymbol) {
+        cerr << "Error: the symbol pool and the text maps disagree" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Point lookups on a table of `rows` rows loaded through the whole
+// pipeline (parse, semantic pass, store): SELECT by the primary key, which
+// the key index answers, and by an unindexed copy of it, which needs a
+// scan. Each query is a statement of its own; the latency is that of
+// executing it, and separately of parsing, checking and executing it.
+static int benchLookup(size_t rows) {
+    rows = max<size_t>(rows, 1);
+    Catalog catalog;
+    SemanticAnalyzer analyzer(catalog);
+    ColumnStore store(catalog);
+    Resolution resolution;
+    ValidationScratch scratch;
+    ValidationResult result;
+    Ast ast;
+    vector<StatementError> errors;
+    ostream sink(nullptr);
+    // Parses and checks `sql` into `ast`, then times executing it.
+    auto run = [&](const string &sql, uint64_t &executeNs) {
+        ast.clear();
+        validateSerial(sql, builtinLL1Table, scratch, result, &ast);
+        analyzer.analyze(ast, resolution, errors);
+        Clock::time_point start = Clock::now();
+        store.execute(ast, resolution, sink, errors);
+        executeNs = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+        return result.errors.empty() && errors.empty();
+    };
+    // Distinct keys in a scattered order: multiplying by an odd number is a
+    // bijection modulo 2^40.
+    auto keyOf = [](size_t i) { return to_string((i * 0x9e3779b97f4a7c15ull) & ((1ull << 40) - 1)); };
+
+    uint64_t ns;
+    Clock::time_point start = Clock::now();
+    string sql = "CREATE TABLE kv (id INT, copy INT, PRIMARY KEY (id));\n";
+    for (size_t i = 0; i < rows; i++) {
+        string key = keyOf(i);
+        sql += "INSERT INTO kv VALUES (" + key + ", " + key + ");\n";
+        if (sql.size() >= (1 << 20) || i + 1 == rows) {
+            if (!run(sql, ns)) {
+                cerr << "Error: loading failed" << endl;
+                return 1;
+            }
+            sql.clear();
+        }
+    }
+    double loadSeconds = secondsSince(start);
+    cout << "Table: " << store.rowCount(0) << " rows, " << store.dataBytes() / 1e6 << " MB of columns, "
+         << store.indexBytes() / 1e6 << " MB of key index; loaded in " << loadSeconds << " s ("
+         << rows / loadSeconds / 1e6 << " M rows/s)" << endl;
+
+    mt19937_64 rng(7);
+    for (const char *column : {"id", "copy"}) {
+        bool indexed = string(column) == "id";
+        size_t queries = indexed ? 100000 : max<size_t>(5, 200000000 / max<size_t>(rows, 1));
+        vector<uint64_t> execute, total;
+        size_t returned = store.rowsReturned();
+        for (size_t q = 0; q < queries; q++) {
+            Clock::time_point begin = Clock::now();
+            if (!run("SELECT copy FROM kv WHERE " + string(column) + " = " + keyOf(rng() % rows) + ";", ns)) {
+                cerr << "Error: query failed" << endl;
+                return 1;
+            }
+            execute.push_back(ns);
+            total.push_back(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - begin).count());
+        }
+        if (store.rowsReturned() - returned != queries) {
+            cerr << "Error: " << store.rowsReturned() - returned << " rows for " << queries << " lookups" << endl;
+            return 1;
+        }
+        for (auto *latencies : {&execute, &total}) {
+            sort(latencies->begin(), latencies->end());
+            uint64_t sum = 0;
+            for (uint64_t l : *latencies)
+                sum += l;
+            cout << (indexed ? "by key (index)" : "by copy (scan)") << "\t"
+                 << (latencies == &execute ? "execute" : "parse+check+execute") << "\t" << queries
+                 << " queries\tmean " << sum / 1e3 / queries << " us\tp50 "
+                 << (*latencies)[queries / 2] / 1e3 << " us\tp99 " << (*latencies)[queries * 99 / 100] / 1e3
+                 << " us" << endl;
+        }
+    }
+
+    // A key that is taken is refused.
+    if (run("INSERT INTO kv VALUES (" + keyOf(rows / 2) + ", 0);", ns) || errors.size() != 1) {
+        cerr << "Error: a duplicate key was accepted" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    string what = argc > 1 ? argv[1] : "lexer";
+    if (what == "lexer")
+        return benchLexer(argc > 2 ? strtoul(argv[2], nullptr, 10) : 64);
+    if (what == "input")
+        return benchInput(argc > 2 ? argv[2] : "");
+    if (what == "sets")
+        return benchSets(argc > 2 ? strtoul(argv[2], nullptr, 10) : 10000);
+    if (what == "tables")
+        return benchTables(argc > 2 ? argv[2] : "CFG_grammar.txt");
+    if (what == "tree")
+        return benchTree(argc > 2 ? strtoul(argv[2], nullptr, 10) : 16);
+    if (what == "fused")
+        return benchFused(argc > 2 ? strtoul(argv[2], nullptr, 10) : 64);
+    if (what == "rd")
+        return benchRD(argc > 2 ? strtoul(argv[2], nullptr, 10) : 16);
+    if (what == "engines")
+        return benchEngines(argc > 2 ? strtoul(argv[2], nullptr, 10) : 16);
+    if (what == "api")
+        return benchApi(argc > 2 ? strtoul(argv[2], nullptr, 10) : 16);
+    if (what == "intern")
+        return benchIntern(argc > 2 ? strtoul(argv[2], nullptr, 10) : 16);
+    if (what == "lookup")
+        return benchLookup(argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000000);
+    cerr << "Usage: " << argv[0] << " lexer [MB]" << endl;
+    cerr << "       " << argv[0] << " input [FILE | MB]" << endl;
+    cerr << "       " << argv[0] << " tree [MB]" << endl;
+    cerr << "       " << argv[0] << " sets [PRODUCTIONS]" << endl;
+    cerr << "       " << argv[0] << " tables [GRAMMAR]" << endl;
+    cerr << "       " << argv[0] << " engines [MB]" << endl;
+    cerr << "       " << argv[0] << " rd [MB]" << endl;
+    cerr << "       " << argv[0] << " fused [MB]" << endl;
+    cerr << "       " << argv[0] << " api [MB]" << endl;
+    cerr << "       " << argv[0] << " intern [MB]" << endl;
+    cerr << "       " << argv[0] << " lookup [ROWS]" << endl;
+    return 1;
+}
@@ -0,0 +1,425 @@
+// Benchmark suite over seeded synthetic workloads (workload.h). Generates
+// a corpus, or maps an existing one, and runs each pipeline stage over it,
+// reporting throughput, latency percentiles and peak RSS per stage:
+//
+//   generate  workload generation, per 1 MB chunk
+//   grammar   FIRST/FOLLOW, parsing table and packed tables from the grammar
+//   lex       Lexer::tokenize, per 1 MB batch
+//   parse     ll1Check, per statement (tokens already lexed)
+//   validate  lex + parse on --jobs threads, per 1 MB batch
+//   analyze   the semantic pass (semantic.h), per 1 MB batch of ASTs
+//   session   ParseSession::parse, one statement per call (server path)
+//
+// Usage: ./sql_bench_suite [--size S] [--mix M] [--seed N] [--jobs N] [--cache N] [--file F]
+//        ./sql_bench_suite --generate F [--size S] [--mix M] [--seed N]
+// S is a byte size such as 1KB, 64MB or 10GB; M is balanced, wide,
+// strings, in or mixed. --generate streams the corpus to F ("-" for
+// stdout) without holding it in memory; --file benchmarks a corpus on disk
+// (memory-mapped, so sizes beyond RAM work). Peak RSS is measured per
+// stage and includes the corpus pages the stage has touched.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+#include "grammar.h"
+#include "input.h"
+#include "lexer.h"
+#include "ll1_table.h"
+#include "parallel.h"
+#include "parser.h"
+#include "parser_api.h"
+#include "semantic.h"
+#include "thread_pool.h"
+#include "workload.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+static uint64_t nanosSince(Clock::time_point start) {
+    return chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// Latency histogram with buckets a sixteenth of a power of two wide, so a
+// percentile is within 7% and any number of samples takes 8 KB.
+class LatencyHistogram {
+public:
+    void add(uint64_t ns) {
+        counts[bucketOf(ns)]++;
+        total++;
+        maxNs = max(maxNs, ns);
+    }
+    void merge(const LatencyHistogram &other) {
+        for (size_t b = 0; b < BUCKETS; b++)
+            counts[b] += other.counts[b];
+        total += other.total;
+        maxNs = max(maxNs, other.maxNs);
+    }
+    size_t count() const { return total; }
+    uint64_t maximum() const { return maxNs; }
+    // Upper bound of the bucket holding the p-quantile sample.
+    uint64_t percentile(double p) const {
+        uint64_t rank = static_cast<uint64_t>(p * total), seen = 0;
+        for (size_t b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (seen > rank)
+                return min(bucketTop(b), maxNs);
+        }
+        return maxNs;
+    }
+
+private:
+    static const size_t SUB = 16;
+    static const size_t BUCKETS = 64 * SUB;
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < SUB)
+            return ns;
+        int e = 63 - __builtin_clzll(ns);   // At least 4.
+        return (e - 3) * SUB + ((ns >> (e - 4)) & (SUB - 1));
+    }
+    static uint64_t bucketTop(size_t b) {
+        if (b < SUB)
+            return b;
+        int e = static_cast<int>(b / SUB) + 3;
+        return ((SUB + b % SUB + 1) << (e - 4)) - 1;
+    }
+
+    uint64_t counts[BUCKETS] = {};
+    size_t total = 0;
+    uint64_t maxNs = 0;
+};
+
+// Starts a new peak-RSS measurement: on Linux, writing 5 to clear_refs
+// resets the high-water mark to the current RSS. Elsewhere the peak is
+// the process's peak so far.
+static void resetPeakRss() {
+    if (FILE *f = fopen("/proc/self/clear_refs", "w")) {
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+static size_t peakRssKB() {
+    if (FILE *f = fopen("/proc/self/status", "r")) {
+        char line[256];
+        size_t kb = 0;
+        while (fgets(line, sizeof line, f)) {
+            if (strncmp(line, "VmHWM:", 6) == 0)
+                kb = strtoul(line + 6, nullptr, 10);
+        }
+        fclose(f);
+        if (kb)
+            return kb;
+    }
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);
+}
+
+struct StageResult {
+    string name;
+    string unit;                // What one latency sample measures.
+    size_t units = 0;
+    uint64_t bytes = 0;         // Input bytes processed; 0 if not meaningful.
+    double seconds = 0;
+    LatencyHistogram latency{};
+    size_t peakKB = 0;
+};
+
+static void printHeader() {
+    cout << left << setw(10) << "stage" << right << setw(12) << "units" << setw(12) << "MB/s" << setw(14)
+         << "units/s" << setw(11) << "p50 us" << setw(11) << "p90 us" << setw(11) << "p99 us" << setw(11)
+         << "p99.9 us" << setw(11) << "max us" << setw(12) << "peak RSS MB" << "  (unit)" << endl;
+}
+
+static void printStage(const StageResult &r) {
+    auto us = [](uint64_t ns) { return ns / 1e3; };
+    cout << left << setw(10) << r.name << right << setw(12) << r.units << fixed << setprecision(1) << setw(12);
+    if (r.bytes)
+        cout << r.bytes / r.seconds / 1e6;
+    else
+        cout << "-";
+    cout << setw(14) << setprecision(0) << r.units / r.seconds << setprecision(2) << setw(11)
+         << us(r.latency.percentile(0.50)) << setw(11) << us(r.latency.percentile(0.90)) << setw(11)
+         << us(r.latency.percentile(0.99)) << setw(11) << us(r.latency.percentile(0.999)) << setw(11)
+         << us(r.latency.maximum()) << setprecision(1) << setw(12) << r.peakKB / 1024.0 << "  (" << r.unit << ")"
+         << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+static StageResult stageGenerate(const WorkloadOptions &options, string &corpus) {
+    StageResult r{"generate", "1 MB chunk"};
+    resetPeakRss();
+    corpus.clear();
+    corpus.reserve(options.bytes + (64 << 10));
+    WorkloadGenerator gen(options);
+    Clock::time_point start = Clock::now();
+    for (;;) {
+        Clock::time_point t = Clock::now();
+        if (!gen.next(corpus))
+            break;
+        r.latency.add(nanosSince(t));
+    }
+    r.seconds = nanosSince(start) / 1e9;
+    r.units = gen.statementsGenerated();
+    r.bytes = corpus.size();
+    r.unit = "1 MB chunk; units are statements";
+    r.peakKB = peakRssKB();
+    return r;
+}
+
+static StageResult stageGrammar() {
+    StageResult r{"grammar", "grammar to tables"};
+    resetPeakRss();
+    vector<Production> grammar = buildGrammar();
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < 200; i++) {
+        Clock::time_point t = Clock::now();
+        ParserContext context(grammar);
+        r.latency.add(nanosSince(t));
+        if (!context.ok()) {
+            cerr << "Error: " << context.error() << endl;
+            break;
+        }
+        r.units++;
+    }
+    r.seconds = nanosSince(start) / 1e9;
+    r.peakKB = peakRssKB();
+    return r;
+}
+
+static StageResult stageLex(string_view input, const vector<size_t> &ends) {
+    StageResult r{"lex", "1 MB batch"};
+    resetPeakRss();
+    Lexer lexer{string_view()};
+    vector<Token> tokens;
+    Clock::time_point start = Clock::now();
+    for (size_t b = 0; b < ends.size(); b++) {
+        size_t begin = b ? ends[b - 1] : 0;
+        Clock::time_point t = Clock::now();
+        lexer.reset(input.substr(begin, ends[b] - begin), begin);
+        lexer.tokenize(tokens);
+        r.latency.add(nanosSince(t));
+        r.units += tokens.size();
+    }
+    r.seconds = nanosSince(start) / 1e9;
+    r.bytes = input.size();
+    r.unit = "1 MB batch; units are tokens";
+    r.peakKB = peakRssKB();
+    return r;
+}
+
+// Throughput comes from an untimed pass over each batch's statements and
+// the latencies from a second pass that times each one, so the clock reads
+// do not count against throughput.
+static StageResult stageParse(string_view input, const vector<size_t> &ends, size_t &errors) {
+    StageResult r{"parse", "statement"};
+    resetPeakRss();
+    const LL1Table &table = builtinLL1Table;
+    Lexer lexer{string_view()};
+    vector<Token> tokens;
+    vector<size_t> starts;
+    vector<uint16_t> stack;
+    string error;
+    uint64_t parseNanos = 0;
+    errors = 0;
+    for (size_t b = 0; b < ends.size(); b++) {
+        size_t begin = b ? ends[b - 1] : 0;
+        lexer.reset(input.substr(begin, ends[b] - begin), begin);
+        lexer.tokenize(tokens);
+        starts.clear();
+        starts.push_back(0);
+        for (size_t i = 0; i + 1 < tokens.size(); i++) {
+            if (tokens[i].type == TokenType::SEMICOLON)
+                starts.push_back(i + 1);
+        }
+        if (starts.back() != tokens.size() - 1)
+            starts.push_back(tokens.size() - 1);    // A last statement without ';'.
+        size_t statements = starts.size() - 1;
+
+        Clock::time_point t = Clock::now();
+        for (size_t s = 0; s < statements; s++)
+            errors += !ll1Check(&tokens[starts[s]], starts[s + 1] - starts[s], table, stack, error);
+        parseNanos += nanosSince(t);
+        for (size_t s = 0; s < statements; s++) {
+            Clock::time_point one = Clock::now();
+            ll1Check(&tokens[starts[s]], starts[s + 1] - starts[s], table, stack, error);
+            r.latency.add(nanosSince(one));
+        }
+        r.units += statements;
+    }
+    r.seconds = parseNanos / 1e9;
+    r.bytes = input.size();
+    r.peakKB = peakRssKB();
+    return r;
+}
+
+static StageResult stageValidate(string_view input, const vector<size_t> &ends, unsigned jobs, size_t cacheEntries,
+                                 size_t &errors) {
+    StageResult r{"validate", "1 MB batch"};
+    resetPeakRss();
+    ThreadPool pool(jobs);
+    vector<ValidationScratch> scratch(pool.size());
+    vector<ParseCache> caches(pool.size(), ParseCache(cacheEntries));
+    vector<LatencyHistogram> latency(pool.size());
+    vector<ValidationResult> results(ends.size());
+    Clock::time_point start = Clock::now();
+    pool.parallelFor(ends.size(), [&](size_t b, unsigned worker) {
+        size_t begin = b ? ends[b - 1] : 0;
+        Clock::time_point t = Clock::now();
+        validateSerial(input.substr(begin, ends[b] - begin), builtinLL1Table, scratch[worker], results[b],
+                       nullptr, cacheEntries ? &caches[worker] : nullptr);
+        latency[worker].add(nanosSince(t));
+    });
+    r.seconds = nanosSince(start) / 1e9;
+    errors = 0;
+    for (const auto &result : results) {
+        r.units += result.statements;
+        errors += result.errors.size();
+    }
+    for (const auto &h : latency)
+        r.latency.merge(h);
+    r.bytes = input.size();
+    r.unit = "1 MB batch on " + to_string(pool.size()) + " threads";
+    r.peakKB = peakRssKB();
+    return r;
+}
+
+// The ASTs are built batch by batch, untimed, and only the pass is timed.
+static StageResult stageAnalyze(string_view input, const vector<size_t> &ends, size_t &errors) {
+    StageResult r{"analyze", "1 MB batch"};
+    resetPeakRss();
+    Catalog catalog;
+    SemanticAnalyzer analyzer(catalog);
+    Resolution resolution;
+    ValidationScratch scratch;
+    ValidationResult result;
+    Ast ast;
+    vector<StatementError> semanticErrors;
+    uint64_t total = 0;
+    for (size_t b = 0; b < ends.size(); b++) {
+        size_t begin = b ? ends[b - 1] : 0;
+        ast.clear();
+        validateSerial(input.substr(begin, ends[b] - begin), builtinLL1Table, scratch, result, &ast);
+        Clock::time_point t = Clock::now();
+        analyzer.analyze(ast, resolution, semanticErrors);
+        uint64_t ns = nanosSince(t);
+        total += ns;
+        r.latency.add(ns);
+        r.units += ast.size();
+    }
+    errors = semanticErrors.size();
+    r.seconds = total / 1e9;
+    r.bytes = input.size();
+    r.unit = "1 MB batch; units are statements";
+    r.peakKB = peakRssKB();
+    return r;
+}
+
+static StageResult stageSession(string_view input, const vector<size_t> &ends, size_t cacheEntries) {
+    StageResult r{"session", "statement"};
+    resetPeakRss();
+    ParserContext context;
+    ParseOptions options;
+    options.cacheEntries = cacheEntries;
+    ParseSession session(context, options);
+    uint64_t total = 0;
+    for (size_t b = 0; b < ends.size(); b++) {
+        size_t begin = b ? ends[b - 1] : 0;
+        string_view batch = input.substr(begin, ends[b] - begin);
+        // Every top-level ';' ends a request.
+        vector<size_t> cuts = splitIntoBatches(batch, 1);
+        for (size_t c = 0, from = 0; c < cuts.size(); from = cuts[c++]) {
+            if (batch.find_first_not_of(" \t\r\n", from) >= cuts[c])
+                continue;   // Only whitespace after the last ';'.
+            Clock::time_point t = Clock::now();
+            session.parse(batch.substr(from, cuts[c] - from));
+            uint64_t ns = nanosSince(t);
+            total += ns;
+            r.latency.add(ns);
+            r.units++;
+        }
+    }
+    r.seconds = total / 1e9;
+    r.bytes = input.size();
+    r.peakKB = peakRssKB();
+    return r;
+}
+
+int main(int argc, char **argv) {
+    WorkloadOptions options;
+    unsigned jobs = 0;
+    size_t cacheEntries = 0;
+    string path, generatePath;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        bool ok = a + 1 < argc;
+        if (ok && arg == "--size")
+            ok = parseByteSize(argv[++a], options.bytes);
+        else if (ok && arg == "--mix")
+            ok = parseWorkloadMix(argv[++a], options.mix);
+        else if (ok && arg == "--seed")
+            options.seed = strtoull(argv[++a], nullptr, 10);
+        else if (ok && arg == "--jobs")
+            jobs = static_cast<unsigned>(strtoul(argv[++a], nullptr, 10));
+        else if (ok && arg == "--cache")
+            cacheEntries = strtoul(argv[++a], nullptr, 10);
+        else if (ok && arg == "--file")
+            path = argv[++a];
+        else if (ok && arg == "--generate")
+            generatePath = argv[++a];
+        else
+            ok = false;
+        if (!ok) {
+            cerr << "Usage: " << argv[0]
+                 << " [--size S] [--mix balanced|wide|strings|in|mixed] [--seed N] [--jobs N] [--cache N]"
+                 << " [--file F | --generate F]" << endl;
+            return 1;
+        }
+    }
+    if (!generatePath.empty())
+        return writeWorkload(generatePath, options) ? 0 : 1;
+
+    vector<StageResult> results;
+    string corpus;
+    InputFile file;
+    string_view input;
+    if (path.empty()) {
+        results.push_back(stageGenerate(options, corpus));
+        input = corpus;
+        cout << "Corpus: " << workloadMixName(options.mix) << ", seed " << options.seed << ", " << input.size()
+             << " bytes" << endl;
+    } else {
+        if (!file.open(path))
+            return 1;
+        input = file.data();
+        cout << "Corpus: " << path << ", " << input.size() << " bytes" << endl;
+    }
+    vector<size_t> ends = splitIntoBatches(input, 1 << 20);
+
+    size_t parseErrors, validateErrors, semanticErrors;
+    results.push_back(stageGrammar());
+    results.push_back(stageLex(input, ends));
+    results.push_back(stageParse(input, ends, parseErrors));
+    results.push_back(stageValidate(input, ends, jobs, cacheEntries, validateErrors));
+    results.push_back(stageAnalyze(input, ends, semanticErrors));
+    results.push_back(stageSession(input, ends, cacheEntries));
+
+    printHeader();
+    for (const auto &r : results)
+        printStage(r);
+    if (parseErrors || validateErrors) {
+        cerr << (path.empty() ? "Error: " : "Note: ") << validateErrors << " statements with syntax errors" << endl;
+        return path.empty() ? 1 : 0;
+    }
+    if (semanticErrors) {
+        cerr << (path.empty() ? "Error: " : "Note: ") << semanticErrors << " statements with semantic errors" << endl;
+        return path.empty() ? 1 : 0;
+    }
+    return 0;
+}
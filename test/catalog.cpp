@@ -0,0 +1,63 @@
+#include "catalog.h"
+#include <cctype>
+using namespace std;
+
+static bool equalsIgnoreCase(string_view a, const char *b) {
+    size_t i = 0;
+    for (; i < a.size() && b[i]; i++) {
+        if (toupper(static_cast<unsigned char>(a[i])) != b[i])
+            return false;
+    }
+    return i == a.size() && !b[i];
+}
+
+bool columnTypeFromName(string_view type, ColumnType &out) {
+    static const struct {
+        const char *name;
+        ColumnType type;
+    } TYPES[] = {
+        {"INT", ColumnType::Integer}, {"INTEGER", ColumnType::Integer}, {"SMALLINT", ColumnType::Integer},
+        {"BIGINT", ColumnType::Integer}, {"DECIMAL", ColumnType::Decimal}, {"NUMERIC", ColumnType::Decimal},
+        {"FLOAT", ColumnType::Decimal}, {"DOUBLE", ColumnType::Decimal}, {"REAL", ColumnType::Decimal},
+        {"VARCHAR", ColumnType::Text}, {"CHAR", ColumnType::Text}, {"TEXT", ColumnType::Text},
+        {"STRING", ColumnType::Text}, {"DATE", ColumnType::Text},
+    };
+    for (const auto &t : TYPES) {
+        if (equalsIgnoreCase(type, t.name)) {
+            out = t.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *columnTypeName(ColumnType type) {
+    switch (type) {
+        case ColumnType::Integer: return "INT";
+        case ColumnType::Decimal: return "DECIMAL";
+        default: return "VARCHAR";
+    }
+}
+
+uint32_t Catalog::addTable(uint32_t name) {
+    uint32_t id = static_cast<uint32_t>(tables.name.size());
+    if (!tableIndex.insert(name, id))
+        return NO_ID;
+    tables.name.push_back(name);
+    tables.firstColumn.push_back(static_cast<uint32_t>(columns.name.size()));
+    tables.columnCount.push_back(0);
+    tables.primaryKey.push_back(NO_ID);
+    return id;
+}
+
+uint32_t Catalog::addColumn(uint32_t name, ColumnType type) {
+    uint32_t table = static_cast<uint32_t>(tables.name.size() - 1);
+    uint32_t id = static_cast<uint32_t>(columns.name.size());
+    if (!columnIndex.insert(static_cast<uint64_t>(table) << 32 | name, id))
+        return NO_ID;
+    columns.name.push_back(name);
+    columns.type.push_back(type);
+    columns.table.push_back(table);
+    tables.columnCount[table]++;
+    return id;
+}
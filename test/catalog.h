@@ -0,0 +1,58 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "symbols.h"
+using namespace std;
+
+enum class ColumnType : uint8_t { Integer, Decimal, Text };
+
+// Maps a declared type name (INT, DECIMAL, VARCHAR and their usual
+// synonyms, in any case) to its ColumnType; false if unknown.
+bool columnTypeFromName(string_view type, ColumnType &out);
+const char *columnTypeName(ColumnType type);
+
+// Tables and columns declared by CREATE TABLE, as IDs. Table IDs and
+// column IDs are dense; a table's columns have consecutive IDs, in
+// declaration order. Names are symbols (symbols.h), so they are
+// case-sensitive, as the lexer keeps them.
+class Catalog {
+public:
+    struct Tables {
+        vector<uint32_t> name;
+        vector<uint32_t> firstColumn;
+        vector<uint32_t> columnCount;
+        vector<uint32_t> primaryKey;    // Column ID, or NO_ID.
+    } tables;
+
+    struct Columns {
+        vector<uint32_t> name;
+        vector<ColumnType> type;
+        vector<uint32_t> table;
+    } columns;
+
+    // Table ID for a name symbol, or NO_ID.
+    uint32_t findTable(uint32_t name) const { return tableIndex.find(name); }
+    // Column ID of `name` in `table`, or NO_ID.
+    uint32_t findColumn(uint32_t table, uint32_t name) const {
+        return columnIndex.find(static_cast<uint64_t>(table) << 32 | name);
+    }
+    // Adds an empty table; NO_ID if one of that name exists.
+    uint32_t addTable(uint32_t name);
+    // Adds a column to the table added last (its columns must be
+    // consecutive); NO_ID if it has one of that name already.
+    uint32_t addColumn(uint32_t name, ColumnType type);
+    // Makes `column` the primary key of its table.
+    void setPrimaryKey(uint32_t column) { tables.primaryKey[columns.table[column]] = column; }
+
+    size_t tableCount() const { return tables.name.size(); }
+    size_t columnCount() const { return columns.name.size(); }
+
+private:
+    IdMap tableIndex;
+    IdMap columnIndex;
+};
+
+#endif // CATALOG_H
@@ -1,5 +1,6 @@
 #include "grammar.h"
 #include <algorithm>
+#include <unordered_map>
 
 const string EPSILON = "EPSILON";
 
@@ -56,8 +57,9 @@ grammar.push_back({"<column_def>", {"PRIMARY", "KEY", "(", "<identifier>", ")"}}
     // 20. <value_list_tail> -> EPSILON
     grammar.push_back({"<value_list_tail>", {EPSILON}});
     
-    // 21. <select_stmt> -> "SELECT" <select_list> "FROM" <identifier> <opt_where_clause> ";"
-    grammar.push_back({"<select_stmt>", {"SELECT", "<select_list>", "FROM", "<identifier>", "<opt_where_clause>", ";"}});
+    // 21. <select_stmt> -> "SELECT" <select_list> "FROM" <identifier> <opt_where_clause>
+    // (The terminating ";" comes from <sql>, as for the other statements.)
+    grammar.push_back({"<select_stmt>", {"SELECT", "<select_list>", "FROM", "<identifier>", "<opt_where_clause>"}});
     
     // 22. <select_list> -> "*"
     grammar.push_back({"<select_list>", {"*"}});
@@ -115,8 +117,9 @@ grammar.push_back({"<condition_tail>", {"IN", "(", "<value_list>", ")"}});
     return grammar;
 }
 
-// Compute the FIRST sets for all grammar symbols.
-map<string, set<string>> computeFirstSets(const vector<Production>& grammar) {
+// Compute the FIRST sets for all grammar symbols by iterating over every
+// production until nothing changes.
+map<string, set<string>> computeFirstSetsFixedPoint(const vector<Production>& grammar) {
     map<string, set<string>> first;
     
     // Initialize FIRST sets for terminals.
@@ -161,14 +164,16 @@ map<string, set<string>> computeFirstSets(const vector<Production>& grammar) {
     return first;
 }
 
-// Compute the FOLLOW sets for all nonterminals.
-map<string, set<string>> computeFollowSets(const vector<Production>& grammar, const map<string, set<string>> &first) {
+// Compute the FOLLOW sets for all nonterminals by iterating over every
+// production until nothing changes.
+map<string, set<string>> computeFollowSetsFixedPoint(const vector<Production>& grammar,
+                                                     const map<string, set<string>> &first) {
     map<string, set<string>> follow;
     for (const auto &prod : grammar) {
         if (isNonTerminal(prod.lhs))
             follow[prod.lhs]; // default empty set
     }
-    follow["<sql>"].insert("$");
+    follow[grammar.front().lhs].insert("$");   // The start symbol (<sql>).
     
     bool changed = true;
     while (changed) {
@@ -203,6 +208,200 @@ map<string, set<string>> computeFollowSets(const vector<Production>& grammar, co
     return follow;
 }
 
+GrammarSets computeGrammarSets(const vector<Production>& grammar) {
+    GrammarSets sets;
+
+    // Symbol IDs: terminals in order of first appearance, then "$", then
+    // nonterminals in order of definition (and any used but never defined).
+    unordered_map<string, uint32_t> id;
+    vector<string> nonTerminals;
+    for (const auto &prod : grammar) {
+        for (const auto &sym : prod.rhs) {
+            if (sym != EPSILON && !isNonTerminal(sym) && id.emplace(sym, sets.symbols.size()).second)
+                sets.symbols.push_back(sym);
+        }
+    }
+    id.emplace("$", sets.symbols.size());
+    sets.symbols.push_back("$");
+    sets.numTerminals = sets.symbols.size();
+    auto addNonTerminal = [&](const string &nt) {
+        if (id.emplace(nt, sets.symbols.size()).second)
+            sets.symbols.push_back(nt);
+    };
+    for (const auto &prod : grammar)
+        addNonTerminal(prod.lhs);
+    for (const auto &prod : grammar) {
+        for (const auto &sym : prod.rhs) {
+            if (isNonTerminal(sym))
+                addNonTerminal(sym);
+        }
+    }
+    size_t numSymbols = sets.symbols.size();
+    size_t numNonTerminals = numSymbols - sets.numTerminals;
+    size_t words = sets.words = (sets.numTerminals + 63) / 64;
+    auto isTerminal = [&](uint32_t s) { return s < sets.numTerminals; };
+    auto nt = [&](uint32_t s) { return s - sets.numTerminals; };
+
+    // Productions on IDs, EPSILON left out.
+    vector<uint32_t> lhs(grammar.size());
+    vector<uint32_t> rhsBegin(grammar.size() + 1);
+    vector<uint32_t> rhs;
+    for (size_t p = 0; p < grammar.size(); p++) {
+        lhs[p] = id[grammar[p].lhs];
+        rhsBegin[p] = static_cast<uint32_t>(rhs.size());
+        for (const auto &sym : grammar[p].rhs) {
+            if (sym != EPSILON)
+                rhs.push_back(id[sym]);
+        }
+    }
+    rhsBegin[grammar.size()] = static_cast<uint32_t>(rhs.size());
+
+    // Nullable: a production becomes nullable once all the symbols on its
+    // RHS are. Each production keeps a count of RHS symbols not yet known
+    // nullable; a newly nullable nonterminal decrements the productions it
+    // occurs in, so each occurrence is visited once.
+    vector<vector<uint32_t>> occursIn(numNonTerminals);
+    vector<uint32_t> pending(grammar.size());
+    vector<uint32_t> work;
+    sets.nullable.assign(numSymbols, 0);
+    for (size_t p = 0; p < grammar.size(); p++) {
+        pending[p] = rhsBegin[p + 1] - rhsBegin[p];
+        for (uint32_t k = rhsBegin[p]; k < rhsBegin[p + 1]; k++) {
+            if (!isTerminal(rhs[k]))
+                occursIn[nt(rhs[k])].push_back(static_cast<uint32_t>(p));
+        }
+        if (pending[p] == 0 && !sets.nullable[lhs[p]]) {
+            sets.nullable[lhs[p]] = 1;
+            work.push_back(lhs[p]);
+        }
+    }
+    while (!work.empty()) {
+        uint32_t x = work.back();
+        work.pop_back();
+        for (uint32_t p : occursIn[nt(x)]) {
+            if (--pending[p] == 0 && !sets.nullable[lhs[p]]) {
+                sets.nullable[lhs[p]] = 1;
+                work.push_back(lhs[p]);
+            }
+        }
+    }
+
+    // Propagates bitset rows along `edges` (from -> dependents) until no
+    // row changes. Only rows whose input changed are reprocessed.
+    auto propagate = [&](vector<uint64_t> &rows, vector<vector<uint32_t>> &edges) {
+        vector<uint8_t> queued(numNonTerminals, 1);
+        work.clear();
+        for (uint32_t n = 0; n < numNonTerminals; n++) {
+            sort(edges[n].begin(), edges[n].end());
+            edges[n].erase(unique(edges[n].begin(), edges[n].end()), edges[n].end());
+            work.push_back(n);
+        }
+        while (!work.empty()) {
+            uint32_t from = work.back();
+            work.pop_back();
+            queued[from] = 0;
+            const uint64_t *src = &rows[from * words];
+            for (uint32_t to : edges[from]) {
+                uint64_t *dst = &rows[to * words];
+                uint64_t added = 0;
+                for (size_t w = 0; w < words; w++) {
+                    added |= src[w] & ~dst[w];
+                    dst[w] |= src[w];
+                }
+                if (added && !queued[to]) {
+                    queued[to] = 1;
+                    work.push_back(to);
+                }
+            }
+        }
+    };
+
+    // FIRST(A) holds the first terminal of every RHS of A, and FIRST(X)
+    // for every X on a RHS of A that follows only nullable symbols.
+    sets.first.assign(numNonTerminals * words, 0);
+    vector<vector<uint32_t>> firstEdges(numNonTerminals);
+    for (size_t p = 0; p < grammar.size(); p++) {
+        uint64_t *row = &sets.first[nt(lhs[p]) * words];
+        for (uint32_t k = rhsBegin[p]; k < rhsBegin[p + 1]; k++) {
+            uint32_t x = rhs[k];
+            if (isTerminal(x)) {
+                row[x / 64] |= uint64_t(1) << (x % 64);
+                break;
+            }
+            firstEdges[nt(x)].push_back(nt(lhs[p]));
+            if (!sets.nullable[x])
+                break;
+        }
+    }
+    propagate(sets.first, firstEdges);
+
+    // FOLLOW(B) for B in A -> alpha B beta holds FIRST(beta), and FOLLOW(A)
+    // when beta is nullable. FIRST(beta) is accumulated right to left.
+    sets.follow.assign(numNonTerminals * words, 0);
+    size_t start = nt(id[grammar.front().lhs]);
+    size_t end = sets.numTerminals - 1;
+    sets.follow[start * words + end / 64] |= uint64_t(1) << (end % 64);
+    vector<vector<uint32_t>> followEdges(numNonTerminals);
+    vector<uint64_t> suffix(words);
+    for (size_t p = 0; p < grammar.size(); p++) {
+        fill(suffix.begin(), suffix.end(), 0);
+        bool suffixNullable = true;
+        for (uint32_t k = rhsBegin[p + 1]; k-- > rhsBegin[p];) {
+            uint32_t x = rhs[k];
+            if (isTerminal(x)) {
+                fill(suffix.begin(), suffix.end(), 0);
+                suffix[x / 64] |= uint64_t(1) << (x % 64);
+                suffixNullable = false;
+                continue;
+            }
+            uint64_t *row = &sets.follow[nt(x) * words];
+            for (size_t w = 0; w < words; w++)
+                row[w] |= suffix[w];
+            if (suffixNullable)
+                followEdges[nt(lhs[p])].push_back(nt(x));
+            const uint64_t *fx = &sets.first[nt(x) * words];
+            if (sets.nullable[x]) {
+                for (size_t w = 0; w < words; w++)
+                    suffix[w] |= fx[w];
+            } else {
+                copy(fx, fx + words, suffix.begin());
+                suffixNullable = false;
+            }
+        }
+    }
+    propagate(sets.follow, followEdges);
+    return sets;
+}
+
+// Converts rows of terminal bits back to named sets.
+static void addTerminals(const GrammarSets &sets, const uint64_t *row, set<string> &out) {
+    for (size_t w = 0; w < sets.words; w++) {
+        for (uint64_t bits = row[w]; bits; bits &= bits - 1)
+            out.insert(sets.symbols[w * 64 + __builtin_ctzll(bits)]);
+    }
+}
+
+map<string, set<string>> firstSetsAsMap(const GrammarSets &sets) {
+    map<string, set<string>> first;
+    for (size_t t = 0; t + 1 < sets.numTerminals; t++)
+        first[sets.symbols[t]].insert(sets.symbols[t]);
+    first[EPSILON].insert(EPSILON);
+    for (size_t s = sets.numTerminals; s < sets.symbols.size(); s++) {
+        set<string> &out = first[sets.symbols[s]];
+        addTerminals(sets, sets.firstRow(s), out);
+        if (sets.nullable[s])
+            out.insert(EPSILON);
+    }
+    return first;
+}
+
+map<string, set<string>> followSetsAsMap(const GrammarSets &sets) {
+    map<string, set<string>> follow;
+    for (size_t s = sets.numTerminals; s < sets.symbols.size(); s++)
+        addTerminals(sets, sets.followRow(s), follow[sets.symbols[s]]);
+    return follow;
+}
+
 // Construct the LL(1) parsing table.
 map<pair<string, string>, vector<int>> constructParsingTable(const vector<Production>& grammar,
                                                               const map<string, set<string>> &first,
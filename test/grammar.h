@@ -1,6 +1,7 @@
 #ifndef GRAMMAR_H
 #define GRAMMAR_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -21,10 +22,35 @@ inline bool isNonTerminal(const string &s) {
     return !s.empty() && s.front() == '<' && s.back() == '>';
 }
 
+// FIRST, FOLLOW and nullable over dense symbol IDs. Terminals take IDs
+// [0, numTerminals), with "$" the last of them; nonterminals follow. FIRST
+// and FOLLOW rows are bitsets of `words` 64-bit words over terminal IDs.
+struct GrammarSets {
+    vector<string> symbols;
+    size_t numTerminals = 0;
+    size_t words = 0;
+    vector<uint8_t> nullable;   // [symbol]
+    vector<uint64_t> first;     // [(symbol - numTerminals) * words + w]
+    vector<uint64_t> follow;
+
+    const uint64_t *firstRow(size_t sym) const { return &first[(sym - numTerminals) * words]; }
+    const uint64_t *followRow(size_t sym) const { return &follow[(sym - numTerminals) * words]; }
+};
+
 // Function prototypes.
 vector<Production> buildGrammar();
-map<string, set<string>> computeFirstSets(const vector<Production>& grammar);
-map<string, set<string>> computeFollowSets(const vector<Production>& grammar, const map<string, set<string>> &first);
+
+// Nullable, FIRST and FOLLOW by worklists over a dependency graph: a
+// nonterminal's set is only recomputed when a set it depends on grew.
+GrammarSets computeGrammarSets(const vector<Production>& grammar);
+// FIRST and FOLLOW as named sets (EPSILON marks nullable symbols).
+map<string, set<string>> firstSetsAsMap(const GrammarSets &sets);
+map<string, set<string>> followSetsAsMap(const GrammarSets &sets);
+
+// The original fixed-point versions, kept to check and benchmark the above.
+map<string, set<string>> computeFirstSetsFixedPoint(const vector<Production>& grammar);
+map<string, set<string>> computeFollowSetsFixedPoint(const vector<Production>& grammar,
+                                                     const map<string, set<string>> &first);
 map<pair<string, string>, vector<int>> constructParsingTable(const vector<Production>& grammar,
                                                               const map<string, set<string>> &first,
                                                               const map<string, set<string>> &follow);
@@ -0,0 +1,77 @@
+#include "input.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+InputFile::InputFile() : mapping(nullptr), mappedSize(0) {}
+
+InputFile::~InputFile() {
+    close();
+}
+
+void InputFile::close() {
+    if (mapping)
+        munmap(mapping, mappedSize);
+    mapping = nullptr;
+    mappedSize = 0;
+    buffer.clear();
+    view = string_view();
+}
+
+// Buffered fallback for inputs that cannot be mapped.
+bool InputFile::readAll(int fd) {
+    const size_t chunk = 1 << 20;
+    size_t used = 0;
+    for (;;) {
+        buffer.resize(used + chunk);
+        ssize_t n = ::read(fd, &buffer[used], chunk);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            buffer.clear();
+            return false;
+        }
+        if (n == 0)
+            break;
+        used += static_cast<size_t>(n);
+    }
+    buffer.resize(used);
+    view = buffer;
+    return true;
+}
+
+bool InputFile::open(const string &path) {
+    close();
+    bool isStdin = path == "-";
+    int fd = isStdin ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error: Unable to open file " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+
+    struct stat st;
+    bool ok = true;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            mapping = p;
+            mappedSize = static_cast<size_t>(st.st_size);
+            // The lexer makes one front-to-back pass: read ahead aggressively
+            // and let the kernel drop pages behind us.
+            madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+            view = string_view(static_cast<const char *>(mapping), mappedSize);
+        }
+    }
+    if (!mapping && !readAll(fd)) {
+        cerr << "Error: Unable to read " << path << ": " << strerror(errno) << endl;
+        ok = false;
+    }
+    if (!isStdin)
+        ::close(fd);
+    return ok;
+}
@@ -0,0 +1,33 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <string>
+#include <string_view>
+using namespace std;
+
+// Read-only view of a whole SQL script. Regular files are memory-mapped
+// with a sequential-access hint so the lexer reads straight from the page
+// cache; pipes, terminals and other unmappable inputs fall back to buffered
+// reads into memory. The view stays valid until the InputFile is destroyed.
+class InputFile {
+public:
+    InputFile();
+    ~InputFile();
+    InputFile(const InputFile &) = delete;
+    InputFile &operator=(const InputFile &) = delete;
+
+    // Opens `path` ("-" reads standard input). Reports failures on cerr.
+    bool open(const string &path);
+    string_view data() const { return view; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    void *mapping;
+    size_t mappedSize;
+    string buffer;      // Contents when the input could not be mapped.
+    string_view view;
+    bool readAll(int fd);
+    void close();
+};
+
+#endif // INPUT_H
@@ -0,0 +1,120 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include "token.h"
+#include <cstdint>
+#include <string_view>
+using namespace std;
+
+// Keyword recognition through a perfect hash generated at compile time from
+// SQL_KEYWORDS in token.h. A lookup hashes the word once, probes a single
+// slot and does one case-insensitive compare; nothing is allocated.
+
+struct KeywordSlot {
+    string_view text;   // Upper-case spelling; empty for unused slots.
+    TokenType type = TokenType::IDENTIFIER;
+};
+
+namespace keyword_detail {
+
+constexpr string_view names[] = {
+#define X(kw) #kw,
+    SQL_KEYWORDS(X)
+#undef X
+};
+constexpr TokenType types[] = {
+#define X(kw) TokenType::kw,
+    SQL_KEYWORDS(X)
+#undef X
+};
+constexpr size_t keywordCount = sizeof(types) / sizeof(types[0]);
+
+// Smallest power of two with at least twice as many slots as keywords.
+constexpr size_t computeSlotCount() {
+    size_t n = 1;
+    while (n < 2 * keywordCount)
+        n <<= 1;
+    return n;
+}
+constexpr size_t slotCount = computeSlotCount();
+constexpr size_t slotMask = slotCount - 1;
+
+constexpr size_t minLength() {
+    size_t m = names[0].size();
+    for (size_t i = 1; i < keywordCount; i++)
+        m = names[i].size() < m ? names[i].size() : m;
+    return m;
+}
+constexpr size_t maxLength() {
+    size_t m = 0;
+    for (size_t i = 0; i < keywordCount; i++)
+        m = names[i].size() > m ? names[i].size() : m;
+    return m;
+}
+constexpr size_t minLen = minLength();
+constexpr size_t maxLen = maxLength();
+
+// FNV-1a over the case-folded bytes. Setting bit 5 maps A-Z onto a-z and
+// leaves digits unchanged, which is all identifiers can contain besides '_'.
+constexpr uint32_t foldHash(string_view word, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : word) {
+        h ^= static_cast<unsigned char>(c) | 0x20u;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+constexpr bool collisionFree(uint32_t seed) {
+    bool used[slotCount] = {};
+    for (size_t i = 0; i < keywordCount; i++) {
+        size_t slot = foldHash(names[i], seed) & slotMask;
+        if (used[slot])
+            return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t noSeed = 0xFFFFFFFFu;
+
+constexpr uint32_t findSeed() {
+    for (uint32_t seed = 0; seed < 100000; seed++) {
+        if (collisionFree(seed))
+            return seed;
+    }
+    return noSeed;
+}
+constexpr uint32_t seed = findSeed();
+static_assert(seed != noSeed, "no perfect hash seed for SQL_KEYWORDS; widen the search");
+
+struct Table {
+    KeywordSlot slots[slotCount];
+    constexpr Table() : slots{} {
+        for (size_t i = 0; i < keywordCount; i++)
+            slots[foldHash(names[i], seed) & slotMask] = {names[i], types[i]};
+    }
+};
+inline constexpr Table slotTable{};
+
+} // namespace keyword_detail
+
+// Returns the keyword type for `word` (matched case-insensitively), or
+// TokenType::IDENTIFIER when it is not a keyword.
+inline TokenType lookupKeyword(string_view word) {
+    namespace kd = keyword_detail;
+    if (word.size() < kd::minLen || word.size() > kd::maxLen)
+        return TokenType::IDENTIFIER;
+    const KeywordSlot &slot = kd::slotTable.slots[kd::foldHash(word, kd::seed) & kd::slotMask];
+    if (slot.text.size() != word.size())
+        return TokenType::IDENTIFIER;
+    // Keywords are upper-case letters, so clearing bit 5 of the input byte
+    // matches exactly the two cases of each letter.
+    for (size_t i = 0; i < word.size(); i++) {
+        if ((static_cast<unsigned char>(word[i]) & 0xDFu) != static_cast<unsigned char>(slot.text[i]))
+            return TokenType::IDENTIFIER;
+    }
+    return slot.type;
+}
+
+#endif // KEYWORDS_H
@@ -0,0 +1,354 @@
+#include "lalr.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+using namespace std;
+
+LALRTable LALRTableData::view() const {
+    LALRTable t;
+    t.numTerminals = numTerminals;
+    t.numSymbols = static_cast<uint16_t>(symbols.size());
+    t.numStates = numStates;
+    t.numProductions = static_cast<uint16_t>(productionLhs.size());
+    t.endTerminal = endTerminal;
+    t.symbolNames = symbolNames.data();
+    t.action = action.data();
+    t.gotoState = gotoState.data();
+    t.productionLhs = productionLhs.data();
+    t.productionLength = productionLength.data();
+    t.tokenTerminal = tokenTerminal.data();
+    return t;
+}
+
+LALRTableData compileLALRTable(const vector<Production>& grammar) {
+    LALRTableData data;
+    GrammarSets sets = computeGrammarSets(grammar);
+    const size_t numTerminals = sets.numTerminals;
+    const size_t numSymbols = sets.symbols.size();
+    const size_t words = sets.words;
+    const uint32_t NONE = UINT32_MAX;
+    unordered_map<string, uint32_t> id;
+    for (size_t s = 0; s < numSymbols; s++)
+        id[sets.symbols[s]] = static_cast<uint32_t>(s);
+    auto isTerminal = [&](uint32_t s) { return s < numTerminals; };
+
+    // Productions on IDs, plus the augmented production <start'> -> <start>
+    // at index P. Its LHS gets the otherwise unused ID numSymbols.
+    const size_t P = grammar.size();
+    vector<uint32_t> lhs(P + 1), rhsBegin(P + 2), rhs;
+    vector<vector<uint32_t>> productionsOf(numSymbols - numTerminals);
+    for (size_t p = 0; p < P; p++) {
+        lhs[p] = id[grammar[p].lhs];
+        productionsOf[lhs[p] - numTerminals].push_back(static_cast<uint32_t>(p));
+        rhsBegin[p] = static_cast<uint32_t>(rhs.size());
+        for (const auto &sym : grammar[p].rhs) {
+            if (sym != EPSILON)
+                rhs.push_back(id[sym]);
+        }
+    }
+    lhs[P] = static_cast<uint32_t>(numSymbols);
+    rhsBegin[P] = static_cast<uint32_t>(rhs.size());
+    rhs.push_back(id[grammar.front().lhs]);
+    rhsBegin[P + 1] = static_cast<uint32_t>(rhs.size());
+
+    // Items: production p with the dot before its d-th RHS symbol is item
+    // itemBase[p] + d.
+    vector<uint32_t> itemBase(P + 2), itemProd;
+    for (size_t p = 0; p <= P; p++) {
+        itemBase[p] = static_cast<uint32_t>(itemProd.size());
+        for (uint32_t d = 0; d <= rhsBegin[p + 1] - rhsBegin[p]; d++)
+            itemProd.push_back(static_cast<uint32_t>(p));
+    }
+    const size_t numItems = itemProd.size();
+    auto afterDot = [&](uint32_t item) -> uint32_t {
+        uint32_t p = itemProd[item];
+        uint32_t k = rhsBegin[p] + (item - itemBase[p]);
+        return k < rhsBegin[p + 1] ? rhs[k] : NONE;
+    };
+
+    // FIRST and nullability of what follows the symbol after the dot, per
+    // item: the lookaheads that item hands to the items it predicts.
+    vector<uint64_t> restFirst(numItems * words, 0);
+    vector<uint8_t> restNullable(numItems, 0);
+    vector<uint64_t> suffix(words);
+    for (size_t p = 0; p <= P; p++) {
+        fill(suffix.begin(), suffix.end(), 0);
+        bool nullable = true;
+        for (uint32_t k = rhsBegin[p + 1]; k-- > rhsBegin[p];) {
+            uint32_t item = itemBase[p] + (k - rhsBegin[p]);
+            copy(suffix.begin(), suffix.end(), &restFirst[item * words]);
+            restNullable[item] = nullable;
+            uint32_t x = rhs[k];
+            if (isTerminal(x)) {
+                fill(suffix.begin(), suffix.end(), 0);
+                suffix[x / 64] |= uint64_t(1) << (x % 64);
+                nullable = false;
+            } else {
+                const uint64_t *fx = sets.firstRow(x);
+                if (sets.nullable[x]) {
+                    for (size_t w = 0; w < words; w++)
+                        suffix[w] |= fx[w];
+                } else {
+                    copy(fx, fx + words, suffix.begin());
+                    nullable = false;
+                }
+            }
+        }
+    }
+
+    // LR(0) automaton. States are identified by their sorted kernels; the
+    // closure of each state is kept, kernel items first.
+    vector<vector<uint32_t>> kernels = {{itemBase[P]}};
+    vector<vector<uint32_t>> closures;
+    vector<vector<pair<uint32_t, uint32_t>>> transitions;   // (symbol, state), by symbol.
+    map<vector<uint32_t>, uint32_t> stateOf = {{kernels[0], 0}};
+    vector<uint32_t> stamp(numSymbols - numTerminals, NONE);
+    map<uint32_t, vector<uint32_t>> advanced;
+    for (uint32_t s = 0; s < kernels.size(); s++) {
+        vector<uint32_t> items = kernels[s];
+        for (size_t k = 0; k < items.size(); k++) {
+            uint32_t x = afterDot(items[k]);
+            if (x == NONE || isTerminal(x) || stamp[x - numTerminals] == s)
+                continue;
+            stamp[x - numTerminals] = s;
+            for (uint32_t q : productionsOf[x - numTerminals])
+                items.push_back(itemBase[q]);
+        }
+        advanced.clear();
+        for (uint32_t item : items) {
+            uint32_t x = afterDot(item);
+            if (x != NONE)
+                advanced[x].push_back(item + 1);
+        }
+        vector<pair<uint32_t, uint32_t>> edges;
+        for (auto &entry : advanced) {
+            vector<uint32_t> &kernel = entry.second;
+            sort(kernel.begin(), kernel.end());
+            auto it = stateOf.find(kernel);
+            if (it == stateOf.end()) {
+                it = stateOf.emplace(kernel, static_cast<uint32_t>(kernels.size())).first;
+                kernels.push_back(kernel);
+            }
+            edges.push_back({entry.first, it->second});
+        }
+        closures.push_back(move(items));
+        transitions.push_back(move(edges));
+    }
+    const size_t numStates = kernels.size();
+    auto gotoOf = [&](uint32_t s, uint32_t x) {
+        auto it = lower_bound(transitions[s].begin(), transitions[s].end(), make_pair(x, uint32_t(0)));
+        return it->second;
+    };
+
+    // Lookaheads of kernel items, propagated to a fixed point with a
+    // worklist of states. Processing a state computes the LR(1) closure of
+    // its kernel, then pushes each item's lookaheads along its transition;
+    // a state is requeued only when one of its kernel sets grew.
+    vector<vector<uint64_t>> lookahead(numStates);
+    for (size_t s = 0; s < numStates; s++)
+        lookahead[s].assign(kernels[s].size() * words, 0);
+    const uint32_t end = static_cast<uint32_t>(numTerminals - 1);
+    lookahead[0][end / 64] |= uint64_t(1) << (end % 64);
+
+    vector<uint64_t> closureLa;
+    vector<uint32_t> prodPos(P + 1, NONE), prodStamp(P + 1, NONE);
+    vector<uint32_t> pending;
+    vector<uint8_t> inPending;
+    auto closeState = [&](uint32_t s) {
+        const vector<uint32_t> &items = closures[s];
+        size_t kernelSize = kernels[s].size();
+        closureLa.assign(items.size() * words, 0);
+        copy(lookahead[s].begin(), lookahead[s].end(), closureLa.begin());
+        for (size_t k = kernelSize; k < items.size(); k++) {
+            prodPos[itemProd[items[k]]] = static_cast<uint32_t>(k);
+            prodStamp[itemProd[items[k]]] = s;
+        }
+        pending.clear();
+        inPending.assign(items.size(), 1);
+        for (size_t k = items.size(); k-- > 0;)
+            pending.push_back(static_cast<uint32_t>(k));
+        while (!pending.empty()) {
+            uint32_t k = pending.back();
+            pending.pop_back();
+            inPending[k] = 0;
+            uint32_t x = afterDot(items[k]);
+            if (x == NONE || isTerminal(x))
+                continue;
+            const uint64_t *first = &restFirst[items[k] * words];
+            const uint64_t *own = &closureLa[k * words];
+            bool passOwn = restNullable[items[k]];
+            for (uint32_t q : productionsOf[x - numTerminals]) {
+                if (prodStamp[q] != s)
+                    continue;  // Not in this closure (cannot happen for reachable items).
+                uint32_t t = prodPos[q];
+                uint64_t *dst = &closureLa[t * words];
+                uint64_t added = 0;
+                for (size_t w = 0; w < words; w++) {
+                    uint64_t bits = first[w] | (passOwn ? own[w] : 0);
+                    added |= bits & ~dst[w];
+                    dst[w] |= bits;
+                }
+                if (added && !inPending[t]) {
+                    inPending[t] = 1;
+                    pending.push_back(t);
+                }
+            }
+        }
+    };
+
+    vector<uint32_t> work;
+    vector<uint8_t> queued(numStates, 1);
+    for (size_t s = numStates; s-- > 0;)
+        work.push_back(static_cast<uint32_t>(s));
+    while (!work.empty()) {
+        uint32_t s = work.back();
+        work.pop_back();
+        queued[s] = 0;
+        closeState(s);
+        const vector<uint32_t> &items = closures[s];
+        for (size_t k = 0; k < items.size(); k++) {
+            uint32_t x = afterDot(items[k]);
+            if (x == NONE)
+                continue;
+            uint32_t t = gotoOf(s, x);
+            const vector<uint32_t> &kernel = kernels[t];
+            size_t pos = lower_bound(kernel.begin(), kernel.end(), items[k] + 1) - kernel.begin();
+            uint64_t *dst = &lookahead[t][pos * words];
+            const uint64_t *src = &closureLa[k * words];
+            uint64_t added = 0;
+            for (size_t w = 0; w < words; w++) {
+                added |= src[w] & ~dst[w];
+                dst[w] |= src[w];
+            }
+            if (added && !queued[t]) {
+                queued[t] = 1;
+                work.push_back(t);
+            }
+        }
+    }
+
+    // Tables.
+    data.symbols = sets.symbols;
+    for (const auto &s : data.symbols)
+        data.symbolNames.push_back(s.c_str());
+    data.numTerminals = static_cast<uint16_t>(numTerminals);
+    data.endTerminal = static_cast<uint16_t>(end);
+    data.numStates = static_cast<uint16_t>(numStates);
+    for (size_t p = 0; p < P; p++) {
+        data.productionLhs.push_back(static_cast<uint16_t>(lhs[p]));
+        data.productionLength.push_back(static_cast<uint16_t>(rhsBegin[p + 1] - rhsBegin[p]));
+    }
+    if (numStates > INT16_MAX - 1 || P >= INT16_MAX) {
+        data.conflicts.push_back("grammar too large: " + to_string(numStates) + " states");
+        return data;
+    }
+    size_t numNonTerminals = numSymbols - numTerminals;
+    data.action.assign(numStates * numTerminals, 0);
+    data.gotoState.assign(numStates * numNonTerminals, 0);
+    for (uint32_t s = 0; s < numStates; s++) {
+        for (const auto &edge : transitions[s]) {
+            if (isTerminal(edge.first))
+                data.action[s * numTerminals + edge.first] = static_cast<int16_t>(edge.second + 1);
+            else
+                data.gotoState[s * numNonTerminals + edge.first - numTerminals] = static_cast<uint16_t>(edge.second);
+        }
+        closeState(s);
+        const vector<uint32_t> &items = closures[s];
+        for (size_t k = 0; k < items.size(); k++) {
+            if (afterDot(items[k]) != NONE)
+                continue;
+            uint32_t p = itemProd[items[k]];
+            for (size_t w = 0; w < words; w++) {
+                for (uint64_t bits = closureLa[k * words + w]; bits; bits &= bits - 1) {
+                    size_t a = w * 64 + __builtin_ctzll(bits);
+                    int16_t &cell = data.action[s * numTerminals + a];
+                    int16_t reduce = static_cast<int16_t>(-static_cast<int>(p) - 1);
+                    if (cell == 0) {
+                        cell = reduce;
+                    } else if (cell != reduce) {
+                        string on = " in state " + to_string(s) + " on " + sets.symbols[a] + ": ";
+                        if (cell > 0) {
+                            data.conflicts.push_back("shift/reduce conflict" + on + "shift or reduce by production " +
+                                                     to_string(p + 1));
+                        } else {
+                            int other = -cell - 1;
+                            data.conflicts.push_back("reduce/reduce conflict" + on + "productions " +
+                                                     to_string(min<int>(other, p) + 1) + " and " +
+                                                     to_string(max<int>(other, p) + 1));
+                            cell = static_cast<int16_t>(-min<int>(other, p) - 1);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    data.tokenTerminal.assign(TOKEN_TYPE_COUNT, -1);
+    for (size_t t = 0; t < TOKEN_TYPE_COUNT; t++) {
+        auto it = id.find(terminalForToken(static_cast<TokenType>(t)));
+        if (it != id.end() && it->second < numTerminals)
+            data.tokenTerminal[t] = static_cast<int16_t>(it->second);
+    }
+    return data;
+}
+
+// Applies the reductions `term` calls for on a copy of `stack`; true if
+// they end in a shift of `term` (or accept), false if in an error.
+static bool lalrShifts(const LALRTable &table, vector<uint16_t> stack, uint16_t term) {
+    for (;;) {
+        int16_t act = table.actionAt(stack.back(), term);
+        if (act >= 0)
+            return act > 0;
+        uint16_t prod = static_cast<uint16_t>(-act - 1);
+        if (prod == table.numProductions)
+            return true;
+        stack.resize(stack.size() - table.productionLength[prod]);
+        stack.push_back(table.gotoAt(stack.back(), table.productionLhs[prod]));
+    }
+}
+
+string lalrError(const Token *tokens, size_t count, size_t i, const LALRTable &table) {
+    string found;
+    int16_t term = i < count ? table.tokenTerminal[static_cast<size_t>(tokens[i].type)] : table.endTerminal;
+    if (term < 0)
+        found = string(tokens[i].lexeme);
+    else
+        found = table.symbolNames[term];
+    // The stack right after tokens[i - 1] was shifted, before any reduction
+    // on tokens[i]; every token before i was shifted, so this cannot fail.
+    vector<uint16_t> stack(1, 0);
+    for (size_t k = 0; k < i;) {
+        uint16_t t = static_cast<uint16_t>(table.tokenTerminal[static_cast<size_t>(tokens[k].type)]);
+        int16_t act = table.actionAt(stack.back(), t);
+        if (act > 0) {
+            stack.push_back(static_cast<uint16_t>(act - 1));
+            k++;
+        } else {
+            uint16_t prod = static_cast<uint16_t>(-act - 1);
+            stack.resize(stack.size() - table.productionLength[prod]);
+            stack.push_back(table.gotoAt(stack.back(), table.productionLhs[prod]));
+        }
+    }
+    string expected;
+    for (uint16_t t = 0; t < table.numTerminals; t++) {
+        if (lalrShifts(table, stack, t))
+            expected += string(expected.empty() ? "" : ", ") + "'" + table.symbolNames[t] + "'";
+    }
+    return "Syntax Error: unexpected '" + found + "', expected " + expected;
+}
+
+bool lalrCheck(const Token *tokens, size_t count, const LALRTable &table,
+               vector<uint16_t> &stack, string &error) {
+    return lalrRun(tokens, count, table, stack, error, [](const Token &) {});
+}
+
+void lalrParse(const vector<Token>& tokens, const LALRTable &table) {
+    vector<uint16_t> stack;
+    string error;
+    if (!lalrCheck(tokens.data(), tokens.size(), table, stack, error)) {
+        cerr << error << endl;
+        return;
+    }
+    cout << "Parsing successful: Input is syntactically correct according to the LALR(1) grammar." << endl;
+}
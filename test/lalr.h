@@ -0,0 +1,131 @@
+#ifndef LALR_H
+#define LALR_H
+
+#include "grammar.h"
+#include "ll1_table.h"
+#include "stats.h"
+#include "token.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+// LALR(1) shift-reduce tables, built from the same Production vector as
+// the LL(1) tables. Symbol IDs follow computeGrammarSets(): terminals
+// first, "$" last among them, then nonterminals. Unlike LL(1), the grammar
+// may be left-recursive and need not be left-factored.
+//
+// Action cells: 0 is a syntax error, s > 0 shifts and goes to state s - 1,
+// r < 0 reduces by production -r - 1. Reducing by the augmented production
+// (index numProductions, <start'> -> <start>) accepts.
+struct LALRTable {
+    uint16_t numTerminals;
+    uint16_t numSymbols;
+    uint16_t numStates;
+    uint16_t numProductions;
+    uint16_t endTerminal;            // "$"
+    const char *const *symbolNames;  // [numSymbols]
+    const int16_t *action;           // [state][terminal]
+    const uint16_t *gotoState;       // [state][nonterminal - numTerminals]
+    const uint16_t *productionLhs;   // [numProductions]
+    const uint16_t *productionLength;  // RHS length, EPSILON counting as 0.
+    const int16_t *tokenTerminal;    // [TokenType] -> terminal ID, -1 if none.
+
+    int16_t actionAt(uint16_t state, uint16_t terminal) const {
+        return action[static_cast<size_t>(state) * numTerminals + terminal];
+    }
+    uint16_t gotoAt(uint16_t state, uint16_t nonTerminal) const {
+        return gotoState[static_cast<size_t>(state) * (numSymbols - numTerminals) + nonTerminal - numTerminals];
+    }
+};
+
+// Owning storage for an LALRTable compiled at run time.
+struct LALRTableData {
+    vector<string> symbols;
+    vector<const char *> symbolNames;
+    vector<int16_t> action;
+    vector<uint16_t> gotoState;
+    vector<uint16_t> productionLhs;
+    vector<uint16_t> productionLength;
+    vector<int16_t> tokenTerminal;
+    uint16_t numTerminals = 0;
+    uint16_t numStates = 0;
+    uint16_t endTerminal = 0;
+    // One message per conflict. Shift/reduce conflicts are resolved as a
+    // shift and reduce/reduce ones in favour of the earlier production.
+    vector<string> conflicts;
+
+    // The view is only valid while this object is alive and unmodified.
+    LALRTable view() const;
+};
+
+// Builds the LR(0) automaton and propagates LALR(1) lookaheads over it
+// until no kernel item's lookahead set grows.
+LALRTableData compileLALRTable(const vector<Production>& grammar);
+
+// Message for tokens[i], which the table has no action for: the token and
+// the terminals that would have been shifted in its place. Merged states
+// can hold lookaheads that are not valid in a given context, so the list
+// is not read from the failing state: tokens[0, i) are parsed again and
+// each terminal is tried from the stack after the last shift.
+string lalrError(const Token *tokens, size_t count, size_t i, const LALRTable &table);
+
+// Shift-reduce loop over tokens[0, count), with positions at or past
+// `count` reading as "$" as for ll1Run(). The stack holds states only.
+// Calls onShift(token) for every shifted token, in input order. If
+// `peakDepth` is not null it receives the deepest stack reached.
+template <class OnShift>
+bool lalrRun(const Token *tokens, size_t count, const LALRTable &table,
+             vector<uint16_t> &stack, string &error, OnShift &&onShift, size_t *peakDepth = nullptr) {
+    ParseCounters<vector<uint16_t>> counters(stack);
+    stack.clear();
+    stack.push_back(0);
+    counters.pushed(1);
+    size_t peak = 1;
+    size_t i = 0;
+    auto terminalAt = [&](size_t k) -> int {
+        return k < count ? table.tokenTerminal[static_cast<size_t>(tokens[k].type)] : table.endTerminal;
+    };
+    int term = terminalAt(0);
+
+    for (;;) {
+        uint16_t state = stack.back();
+        counters.lookup();
+        int16_t act = term < 0 ? 0 : table.actionAt(state, static_cast<uint16_t>(term));
+        if (act > 0) {
+            stack.push_back(static_cast<uint16_t>(act - 1));
+            counters.pushed(1);
+            onShift(tokens[i]);
+            term = terminalAt(++i);
+        } else if (act < 0) {
+            uint16_t prod = static_cast<uint16_t>(-act - 1);
+            if (prod == table.numProductions)
+                break;  // Accept: only ever on "$".
+            stack.resize(stack.size() - table.productionLength[prod]);
+            counters.lookup();
+            stack.push_back(table.gotoAt(stack.back(), table.productionLhs[prod]));
+            counters.pushed(1);
+        } else {
+            error = lalrError(tokens, count, i, table);
+            if (peakDepth)
+                *peakDepth = max(peak, stack.size());
+            counters.flush();
+            return false;
+        }
+        if (stack.size() > peak)
+            peak = stack.size();
+    }
+    if (peakDepth)
+        *peakDepth = peak;
+    counters.flush();
+    return true;
+}
+
+bool lalrCheck(const Token *tokens, size_t count, const LALRTable &table,
+               vector<uint16_t> &stack, string &error);
+
+// Counterpart of ll1Parse(): reports success on cout or the error on cerr.
+void lalrParse(const vector<Token>& tokens, const LALRTable &table);
+
+#endif // LALR_H
@@ -1,189 +1,259 @@
 #include "lexer.h"
-#include <cctype>
-#include <iostream>
-#include <algorithm>
+#include "keywords.h"
+#include "scan.h"
+#include "stats.h"
 
-Lexer::Lexer(const std::string &input) : input(input), pos(0) {}
+Lexer::Lexer(std::string_view input, size_t base) : input(input), pos(0), base(base), hasPending(false) {}
 
-void Lexer::skipWhitespace() {
-    while (pos < input.size() && std::isspace(input[pos]))
-        pos++;
+// Stores a lexeme that does not exist verbatim in the input.
+std::string_view Lexer::ownLexeme(std::string text) {
+    literalPool.push_back(std::move(text));
+    return literalPool.back();
 }
 
-std::string Lexer::readWord() {
-    size_t start = pos;
-    while (pos < input.size() && (std::isalnum(input[pos]) || input[pos] == '_'))
-        pos++;
-    return input.substr(start, pos - start);
+// Returns the body of a string literal in [start, end). Literals without
+// doubled quotes are returned as a view into the input; the rest are
+// unescaped into the literal pool.
+std::string_view Lexer::stringLexeme(size_t start, size_t end, char quote, bool escaped) {
+    std::string_view body = input.substr(start, end - start);
+    if (!escaped)
+        return body;
+    std::string text;
+    text.reserve(body.size());
+    for (size_t i = 0; i < body.size(); i++) {
+        text.push_back(body[i]);
+        if (body[i] == quote && i + 1 < body.size() && body[i + 1] == quote)
+            i++;  // Collapse the doubled quote.
+    }
+    return ownLexeme(std::move(text));
 }
 
-std::string Lexer::readNumber() {
-    size_t start = pos;
-    bool dotSeen = false;
-    while (pos < input.size() && (std::isdigit(input[pos]) || input[pos] == '.')) {
-        if (input[pos] == '.') {
-            if (dotSeen)
-                break;  // Break out if multiple dots occur.
-            dotSeen = true;
-        }
-        pos++;
-    }
-    return input.substr(start, pos - start);
+Token Lexer::keywordOrIdentifier(std::string_view word, size_t offset) {
+    return {lookupKeyword(word), word, offset};
 }
 
-std::string Lexer::readString() {
-    char quote = input[pos];
-    pos++; // Skip the opening quote.
-    size_t start = pos;
-    while (pos < input.size() && input[pos] != quote)
-        pos++;
-    std::string str = input.substr(start, pos - start);
-    if (pos < input.size() && input[pos] == quote)
-        pos++; // Skip the closing quote.
-    else {
-        // Report unterminated string to standard error.
-        std::cerr << "Error: Unterminated string literal starting at position " << start - 1 << std::endl;
+// Returns the next token, END once the input is exhausted.
+Token Lexer::nextToken() {
+    Token tok;
+    if (hasPending) {
+        hasPending = false;
+        tok = pending;
+    } else {
+        scanToken(tok, true);
     }
-    return str;
+    if (interning != Interning::None)
+        internToken(tok);
+    return tok;
 }
 
-Token Lexer::keywordOrIdentifier(const std::string &word) {
-    std::string upperWord = word;
-    std::transform(upperWord.begin(), upperWord.end(), upperWord.begin(), ::toupper);
-    if (upperWord == "CREATE") return {TokenType::CREATE, word};
-    if (upperWord == "TABLE")  return {TokenType::TABLE, word};
-    if (upperWord == "PRIMARY") return {TokenType::PRIMARY, word};
-    if (upperWord == "KEY") return {TokenType::KEY, word};
-    if (upperWord == "INSERT") return {TokenType::INSERT, word};
-    if (upperWord == "INTO") return {TokenType::INTO, word};
-    if (upperWord == "VALUES") return {TokenType::VALUES, word};
-    if (upperWord == "SELECT") return {TokenType::SELECT, word};
-    if (upperWord == "FROM") return {TokenType::FROM, word};
-    if (upperWord == "WHERE") return {TokenType::WHERE, word};
-    if (upperWord == "BETWEEN") return {TokenType::BETWEEN, word};
-    if (upperWord == "AND") return {TokenType::AND, word};
-    if (upperWord == "LIKE") return {TokenType::LIKE, word};
-    if (upperWord == "IN") return {TokenType::IN, word};
-    return {TokenType::IDENTIFIER, word};
+void Lexer::internToken(Token &tok) {
+    if (tok.type == TokenType::IDENTIFIER)
+        tok.symbol = symbols.intern(SymbolKind::Identifier, tok.lexeme);
+    else if (interning == Interning::All && tok.type == TokenType::NUMBER)
+        tok.symbol = symbols.intern(SymbolKind::Number, tok.lexeme);
+    else if (interning == Interning::All && tok.type == TokenType::STRING)
+        tok.symbol = symbols.intern(SymbolKind::String, tok.lexeme);
+}
+
+void Lexer::reset(std::string_view newInput, size_t newBase) {
+    input = newInput;
+    pos = 0;
+    base = newBase;
+    literalPool.clear();
+    hasPending = false;
 }
 
-// The DFA-based tokenize() function with error handling.
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
+    tokenize(tokens);
+    return tokens;
+}
 
+void Lexer::tokenize(std::vector<Token> &tokens) {
+    STATS_PHASE(Phase::Lex);
+    tokens.clear();
+    do {
+        tokens.push_back(nextToken());
+    } while (tokens.back().type != TokenType::END);
+    STATS_ADD(Counter::Tokens, tokens.size());
+}
+
+// The DFA behind nextToken(), run from START until one token is produced.
+// `atEnd` says whether input[] is the whole remaining input. When it is not
+// and a token (or a doubled quote) could continue past the buffer, scanToken
+// rewinds to the start of that token and returns false so the caller can
+// append more input and try again.
+bool Lexer::scanToken(Token &tok, bool atEnd) {
     // Define DFA states.
     enum class State { START, IDENTIFIER, NUMBER, STRING };
     State state = State::START;
-    std::string currentLexeme;
+    size_t tokenStart = pos;   // Offset where the current lexeme begins.
     char currentQuote = '\0';  // For string state.
     bool dotSeen = false;      // For tracking decimal points in numbers.
+    bool escaped = false;      // String literal contains doubled quotes.
 
     while (pos < input.size()) {
         char c = input[pos];
         switch (state) {
             case State::START:
-                if (std::isspace(c)) {  
-                    // Skip whitespace.
-                    pos++;
-                } else if (std::isalpha(c) || c == '_') {
+                if (hasClass(c, CC_SPACE)) {
+                    // Skip the whole whitespace run.
+                    pos = skipSpaces(input.data(), pos, input.size());
+                } else if (hasClass(c, CC_ALPHA)) {
                     // Start building an identifier.
                     state = State::IDENTIFIER;
-                    currentLexeme.clear();
-                } else if (std::isdigit(c)) {
+                    tokenStart = pos;
+                } else if (hasClass(c, CC_DIGIT)) {
                     // Start building a number.
                     state = State::NUMBER;
-                    currentLexeme.clear();
+                    tokenStart = pos;
                     dotSeen = false;
                 } else if (c == '\'' || c == '"') {
                     // Start a string literal.
                     state = State::STRING;
-                    currentLexeme.clear();
                     currentQuote = c;
+                    escaped = false;
+                    tokenStart = pos;
                     pos++; // Skip the opening quote.
                 } else {
                     // Process single-character tokens (symbols, operators).
+                    std::string_view sym = input.substr(pos, 1);
+                    size_t offset = base + pos;
                     switch (c) {
-                        case '(': tokens.push_back({TokenType::LPAREN, "("}); break;
-                        case ')': tokens.push_back({TokenType::RPAREN, ")"}); break;
-                        case ',': tokens.push_back({TokenType::COMMA, ","}); break;
-                        case ';': tokens.push_back({TokenType::SEMICOLON, ";"}); break;
-                        case '*': tokens.push_back({TokenType::ASTERISK, "*"}); break;
-                        case '=': tokens.push_back({TokenType::EQUAL, "="}); break;
-                        case '>': tokens.push_back({TokenType::GREATER, ">"}); break;
-                        case '<': tokens.push_back({TokenType::LESS, "<"}); break;
+                        case '(': tok = {TokenType::LPAREN, sym, offset}; break;
+                        case ')': tok = {TokenType::RPAREN, sym, offset}; break;
+                        case ',': tok = {TokenType::COMMA, sym, offset}; break;
+                        case ';': tok = {TokenType::SEMICOLON, sym, offset}; break;
+                        case '*': tok = {TokenType::ASTERISK, sym, offset}; break;
+                        case '=': tok = {TokenType::EQUAL, sym, offset}; break;
+                        case '>': tok = {TokenType::GREATER, sym, offset}; break;
+                        case '<': tok = {TokenType::LESS, sym, offset}; break;
                         default:
                             // Report unknown character as an error.
-                            tokens.push_back({TokenType::ERROR, std::string("Unknown character: ") + c});
+                            tok = {TokenType::ERROR, ownLexeme(std::string("Unknown character: ") + c), offset};
                             break;
                     }
                     pos++;  // Consume the character.
+                    return true;
                 }
                 break;
 
             case State::IDENTIFIER:
-                if (std::isalnum(c) || c == '_') {
-                    // Continue reading the identifier.
-                    currentLexeme.push_back(c);
-                    pos++;
-                } else {
+                // Read the rest of the identifier in one scan.
+                pos = scanIdentifier(input.data(), pos, input.size());
+                if (pos < input.size()) {
                     // End of identifier: determine if it's a keyword or a plain identifier.
-                    tokens.push_back(keywordOrIdentifier(currentLexeme));
-                    state = State::START;
+                    tok = keywordOrIdentifier(input.substr(tokenStart, pos - tokenStart), base + tokenStart);
+                    return true;
                 }
                 break;
 
             case State::NUMBER:
-                if (std::isdigit(c)) {
-                    currentLexeme.push_back(c);
-                    pos++;
-                } else if (c == '.') {
+                pos = scanDigits(input.data(), pos, input.size());
+                if (pos >= input.size())
+                    break;
+                c = input[pos];
+                if (c == '.') {
                     if (dotSeen) {
                         // Multiple dots in number: report error.
-                        tokens.push_back({TokenType::ERROR,
-                            std::string("Malformed number literal (multiple dots): ") + currentLexeme + c});
+                        std::string_view number = input.substr(tokenStart, pos - tokenStart);
+                        tok = {TokenType::ERROR,
+                            ownLexeme(std::string("Malformed number literal (multiple dots): ") + std::string(number) + c),
+                            base + tokenStart};
                         pos++; // Consume the extra dot.
-                        // Finalize the current number token.
-                        tokens.push_back({TokenType::NUMBER, currentLexeme});
-                        state = State::START;
-                    } else {
-                        dotSeen = true;
-                        currentLexeme.push_back(c);
-                        pos++;
+                        // The number itself is returned by the next call.
+                        pending = {TokenType::NUMBER, number, base + tokenStart};
+                        hasPending = true;
+                        return true;
                     }
+                    dotSeen = true;
+                    pos++;
                 } else {
                     // End of number literal.
-                    tokens.push_back({TokenType::NUMBER, currentLexeme});
-                    state = State::START;
+                    tok = {TokenType::NUMBER, input.substr(tokenStart, pos - tokenStart), base + tokenStart};
+                    return true;
                 }
                 break;
 
             case State::STRING:
-                if (c == currentQuote) {
-                    // End of string literal.
-                    tokens.push_back({TokenType::STRING, currentLexeme});
-                    pos++;  // Consume the closing quote.
-                    state = State::START;
-                } else {
-                    currentLexeme.push_back(c);
-                    pos++;
+                // Jump straight to the next quote character.
+                pos = findByte(input.data(), pos, input.size(), currentQuote);
+                if (pos >= input.size())
+                    break;
+                if (pos + 1 == input.size() && !atEnd) {
+                    // Cannot tell a closing quote from a doubled one yet.
+                    pos = input.size();
+                    break;
                 }
-                break;
+                if (pos + 1 < input.size() && input[pos + 1] == currentQuote) {
+                    // Doubled quote: an escaped quote inside the literal.
+                    escaped = true;
+                    pos += 2;
+                    break;
+                }
+                // End of string literal.
+                tok = {TokenType::STRING, stringLexeme(tokenStart + 1, pos, currentQuote, escaped), base + tokenStart};
+                pos++;  // Consume the closing quote.
+                return true;
         }
     }
 
+    if (!atEnd) {
+        // The token may continue in the next chunk of input.
+        if (state != State::START)
+            pos = tokenStart;
+        return false;
+    }
+
     // Flush any unfinished lexemes.
     if (state == State::IDENTIFIER) {
-        tokens.push_back(keywordOrIdentifier(currentLexeme));
+        tok = keywordOrIdentifier(input.substr(tokenStart), base + tokenStart);
     }
     else if (state == State::NUMBER) {
-        tokens.push_back({TokenType::NUMBER, currentLexeme});
+        tok = {TokenType::NUMBER, input.substr(tokenStart), base + tokenStart};
     }
     else if (state == State::STRING) {
         // Unterminated string literal error.
-        tokens.push_back({TokenType::ERROR, std::string("Unterminated string literal: ") + currentLexeme});
+        tok = {TokenType::ERROR,
+            ownLexeme(std::string("Unterminated string literal: ") + std::string(input.substr(tokenStart + 1))),
+            base + tokenStart};
+    }
+    else {
+        // The END token.
+        tok = {TokenType::END, std::string_view(), base + input.size()};
     }
+    return true;
+}
 
-    // Append the END token.
-    tokens.push_back({TokenType::END, ""});
-    return tokens;
+StreamLexer::StreamLexer(std::istream &in, size_t chunkSize)
+    : Lexer(std::string_view()), in(in), chunkSize(chunkSize), eof(false) {}
+
+// Drops the consumed prefix of the buffer and appends the next chunk.
+void StreamLexer::refill() {
+    base += pos;
+    buffer.erase(0, pos);
+    pos = 0;
+    size_t kept = buffer.size();
+    buffer.resize(kept + chunkSize);
+    in.read(&buffer[kept], chunkSize);
+    buffer.resize(kept + in.gcount());
+    if (!in)
+        eof = true;
+    input = buffer;
+}
+
+Token StreamLexer::nextToken() {
+    Token tok;
+    if (hasPending) {
+        hasPending = false;
+        tok = pending;
+    } else {
+        // The previous token was the last one allowed to reference the pool.
+        literalPool.clear();
+        while (!scanToken(tok, eof))
+            refill();
+    }
+    if (interning != Interning::None)
+        internToken(tok);
+    return tok;
 }
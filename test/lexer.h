@@ -1,28 +1,80 @@
 #ifndef LEXER_H
 #define LEXER_H
-#include "token.h"  
+#include "symbols.h"
+#include "token.h"
+#include <deque>
+#include <istream>
 #include <string>
+#include <string_view>
 #include <vector>
 using namespace std;
 
 
 
 
-// Token structure: type and lexeme.
-
+// Which tokens the lexer interns into the symbol pool (symbols.h), giving
+// them a Token::symbol.
+enum class Interning : uint8_t {
+    None,           // No token; lexing does no hashing.
+    Identifiers,    // IDENTIFIER tokens.
+    All,            // IDENTIFIER, NUMBER and STRING tokens.
+};
 
 class Lexer {
 public:
-    Lexer(const string &input);
+    // The input is not copied: it must stay alive as long as the tokens do.
+    // `base` is added to token offsets when input is a slice of a larger
+    // source.
+    Lexer(string_view input, size_t base = 0);
+    // Starts over on new input, keeping the literal pool's memory, so one
+    // Lexer can serve many inputs. Invalidates lexemes from the old input.
+    void reset(string_view newInput, size_t newBase = 0);
+    // Returns the next token; END (repeatedly) once the input is exhausted.
+    Token nextToken();
     vector<Token> tokenize();
-private:
-    string input;
+    // Same, into `tokens` (cleared first), reusing its capacity.
+    void tokenize(vector<Token> &tokens);
+    // Which tokens get a symbol ID from now on; None by default.
+    void setInterning(Interning mode) { interning = mode; }
+protected:
+    string_view input;
     size_t pos;
-    void skipWhitespace();
-    string readWord();
-    string readNumber();
-    string readString();
-    Token keywordOrIdentifier(const string &word);
+    size_t base;        // Offset of input[0] in the whole source.
+    // Owned storage for lexemes that are not a plain slice of the input
+    // (unescaped string literals and error messages). A deque keeps the
+    // strings in place as it grows, so views into it stay valid.
+    deque<string> literalPool;
+    // A malformed number yields an ERROR token followed by the NUMBER.
+    bool hasPending;
+    Token pending;
+    Interning interning = Interning::None;
+    SymbolCache symbols;
+    bool scanToken(Token &tok, bool atEnd);
+    void internToken(Token &tok);
+private:
+    string_view ownLexeme(string text);
+    string_view stringLexeme(size_t start, size_t end, char quote, bool escaped);
+    Token keywordOrIdentifier(string_view word, size_t offset);
+};
+
+// Pull-based lexer over an input stream, for scripts too large to hold in
+// memory. Input is read in fixed-size chunks into one buffer; when a token
+// runs into the end of the buffer, the unconsumed tail is moved to the front
+// and the next chunk is appended, so no token is split. The buffer only
+// grows beyond one chunk plus the longest token seen so far.
+class StreamLexer : private Lexer {
+public:
+    StreamLexer(istream &in, size_t chunkSize = 64 * 1024);
+    // The returned lexeme is only valid until the next call; the text of
+    // its symbol, if interned, stays valid.
+    Token nextToken();
+    using Lexer::setInterning;
+private:
+    istream &in;
+    string buffer;
+    size_t chunkSize;
+    bool eof;
+    void refill();
 };
 
 #endif // LEXER_H
@@ -0,0 +1,115 @@
+// Generated by tablegen from buildGrammar() in grammar.cpp. Do not edit;
+// rerun tablegen after changing the grammar (see run.txt).
+#include "ll1_table.h"
+
+static const char *const symbolNames[] = {
+    ";",
+    "CREATE",
+    "TABLE",
+    "(",
+    ")",
+    ",",
+    "PRIMARY",
+    "KEY",
+    "INSERT",
+    "INTO",
+    "VALUES",
+    "SELECT",
+    "FROM",
+    "*",
+    "WHERE",
+    "BETWEEN",
+    "AND",
+    "LIKE",
+    "IN",
+    "=",
+    ">",
+    "<",
+    "id",
+    "num",
+    "str",
+    "$",
+    "<sql>",
+    "<sql_tail>",
+    "<statement>",
+    "<create_table_stmt>",
+    "<column_def_list>",
+    "<column_def_list_tail>",
+    "<column_def>",
+    "<insert_stmt>",
+    "<opt_identifier_list>",
+    "<identifier_list>",
+    "<identifier_list_tail>",
+    "<value_list>",
+    "<value_list_tail>",
+    "<select_stmt>",
+    "<select_list>",
+    "<opt_where_clause>",
+    "<where_clause>",
+    "<condition>",
+    "<condition_tail>",
+    "<comp_operator>",
+    "<identifier>",
+    "<datatype>",
+    "<value>",
+    "<number>",
+    "<string>",
+};
+
+static const uint32_t rowBase[] = {
+    1, 0, 2, 38, 10, 0, 27, 32, 31, 20, 2, 0, 31, 32, 24, 38,
+    30, 23, 0, 7, 25, 26, 7, 27, 27,
+};
+
+static const LL1Entry entries[] = {
+    {65535, -1}, {1, 1}, {0, 0}, {2, 3}, {5, 9}, {5, 8}, {10, 17}, {10, 16},
+    {1, 1}, {0, 0}, {2, 4}, {1, 1}, {0, 0}, {2, 5}, {10, 17}, {18, 29},
+    {4, 7}, {18, 30}, {18, 31}, {18, 28}, {18, 28}, {18, 28}, {11, 18}, {11, 18},
+    {11, 18}, {1, 2}, {19, 32}, {19, 33}, {19, 34}, {22, 39}, {22, 37}, {22, 38},
+    {4, 7}, {6, 11}, {8, 13}, {12, 20}, {12, 19}, {14, 22}, {15, 25}, {3, 6},
+    {7, 12}, {8, 14}, {9, 15}, {13, 21}, {16, 26}, {17, 27}, {14, 23}, {20, 35},
+    {21, 36}, {6, 10}, {23, 40}, {24, 41}, {15, 24}, {65535, -1}, {65535, -1}, {65535, -1},
+    {65535, -1}, {65535, -1}, {65535, -1}, {65535, -1}, {65535, -1}, {65535, -1}, {65535, -1}, {65535, -1},
+};
+
+static const uint16_t productionLhs[] = {
+    26, 27, 27, 28, 28, 28, 29, 30, 31, 31, 32, 32, 33, 34, 34, 35,
+    36, 36, 37, 38, 38, 39, 40, 40, 41, 41, 42, 43, 44, 44, 44, 44,
+    45, 45, 45, 46, 47, 48, 48, 48, 49, 50,
+};
+
+static const uint16_t rhsBegin[] = {
+    0, 3, 6, 6, 7, 8, 9, 15, 17, 20, 20, 22, 27, 35, 38, 38,
+    40, 43, 43, 45, 48, 48, 53, 54, 55, 56, 56, 58, 60, 62, 66, 68,
+    72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82,
+};
+
+static const uint16_t rhsSymbols[] = {
+    27, 0, 28, 27, 0, 28, 29, 33, 39, 4, 30, 3, 46, 2, 1, 31,
+    32, 31, 32, 5, 47, 46, 4, 46, 3, 7, 6, 4, 37, 3, 10, 34,
+    46, 9, 8, 4, 35, 3, 36, 46, 36, 46, 5, 38, 48, 38, 48, 5,
+    41, 46, 12, 40, 11, 13, 35, 42, 43, 14, 44, 46, 48, 45, 48, 16,
+    48, 15, 48, 17, 4, 37, 3, 18, 19, 20, 21, 22, 46, 49, 50, 46,
+    23, 24,
+};
+
+static const int16_t tokenTerminal[] = {
+    1, 2, 6, 7, 8, 9, 10, 11, 12, 14, 15, 16, 17, 18, 3, 4,
+    5, 0, 13, 19, 20, 21, 22, 23, 24, -1, 25,
+};
+
+const LL1Table builtinLL1Table = {
+    26,  // numTerminals
+    51,  // numSymbols
+    42,  // numProductions
+    26,  // startSymbol
+    25,  // endTerminal
+    64,  // numEntries
+    symbolNames,
+    rowBase,
+    entries,
+    productionLhs,
+    rhsBegin,
+    rhsSymbols,
+    tokenTerminal,
+};
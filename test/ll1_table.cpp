@@ -0,0 +1,196 @@
+#include "ll1_table.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+using namespace std;
+
+string terminalForToken(TokenType type) {
+    switch (type) {
+        case TokenType::IDENTIFIER: return "id";
+        case TokenType::NUMBER:     return "num";
+        case TokenType::STRING:     return "str";
+        case TokenType::END:        return "$";
+        case TokenType::ERROR:      return "";
+        default:                    return tokenName(type);
+    }
+}
+
+LL1Table LL1TableData::view() const {
+    LL1Table t;
+    t.numTerminals = numTerminals;
+    t.numSymbols = static_cast<uint16_t>(symbols.size());
+    t.numProductions = static_cast<uint16_t>(productionLhs.size());
+    t.startSymbol = startSymbol;
+    t.endTerminal = endTerminal;
+    t.numEntries = static_cast<uint32_t>(entries.size());
+    t.symbolNames = symbolNames.data();
+    t.rowBase = rowBase.data();
+    t.entries = entries.data();
+    t.productionLhs = productionLhs.data();
+    t.rhsBegin = rhsBegin.data();
+    t.rhsSymbols = rhsSymbols.data();
+    t.tokenTerminal = tokenTerminal.data();
+    return t;
+}
+
+// Row displacement: places the rows, fullest first, each at the lowest
+// base where its non-error cells land on unused slots.
+static void packRows(const vector<int16_t> &cells, size_t numTerminals,
+                     vector<uint32_t> &rowBase, vector<LL1Entry> &entries) {
+    size_t numRows = cells.size() / numTerminals;
+    vector<vector<uint16_t>> used(numRows);   // Non-error terminals of each row.
+    for (size_t r = 0; r < numRows; r++) {
+        for (size_t t = 0; t < numTerminals; t++) {
+            if (cells[r * numTerminals + t] != LL1_ERROR)
+                used[r].push_back(static_cast<uint16_t>(t));
+        }
+    }
+    vector<size_t> order(numRows);
+    for (size_t r = 0; r < numRows; r++)
+        order[r] = r;
+    stable_sort(order.begin(), order.end(),
+                [&](size_t a, size_t b) { return used[a].size() > used[b].size(); });
+
+    rowBase.assign(numRows, 0);
+    entries.clear();
+    for (size_t r : order) {
+        size_t base = 0;
+        for (;; base++) {
+            bool fits = true;
+            for (uint16_t t : used[r]) {
+                if (base + t < entries.size() && entries[base + t].row != LL1_NO_ROW) {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits)
+                break;
+        }
+        if (entries.size() < base + numTerminals)
+            entries.resize(base + numTerminals, LL1Entry{LL1_NO_ROW, LL1_ERROR});
+        for (uint16_t t : used[r])
+            entries[base + t] = LL1Entry{static_cast<uint16_t>(r), cells[r * numTerminals + t]};
+        rowBase[r] = static_cast<uint32_t>(base);
+    }
+}
+
+LL1TableData compileLL1Table(const vector<Production>& grammar,
+                             const map<pair<string, string>, vector<int>> &parsingTable) {
+    LL1TableData data;
+
+    // Terminals in order of first appearance, then "$"; then nonterminals in
+    // order of first definition, so the start symbol is the first of them.
+    vector<string> terminals, nonTerminals;
+    unordered_map<string, bool> seen;
+    for (const auto &prod : grammar) {
+        for (const auto &sym : prod.rhs) {
+            if (sym != EPSILON && !isNonTerminal(sym) && !seen[sym]) {
+                seen[sym] = true;
+                terminals.push_back(sym);
+            }
+        }
+    }
+    terminals.push_back("$");
+    for (const auto &prod : grammar) {
+        if (!seen[prod.lhs]) {
+            seen[prod.lhs] = true;
+            nonTerminals.push_back(prod.lhs);
+        }
+    }
+
+    unordered_map<string, uint16_t> id;
+    for (const auto &t : terminals) {
+        id[t] = static_cast<uint16_t>(data.symbols.size());
+        data.symbols.push_back(t);
+    }
+    for (const auto &nt : nonTerminals) {
+        id[nt] = static_cast<uint16_t>(data.symbols.size());
+        data.symbols.push_back(nt);
+    }
+    for (const auto &s : data.symbols)
+        data.symbolNames.push_back(s.c_str());
+    data.numTerminals = static_cast<uint16_t>(terminals.size());
+    data.endTerminal = id["$"];
+    data.startSymbol = id[grammar.front().lhs];
+
+    // Productions: LHS IDs and reversed RHS spans.
+    for (const auto &prod : grammar) {
+        data.productionLhs.push_back(id[prod.lhs]);
+        data.rhsBegin.push_back(static_cast<uint16_t>(data.rhsSymbols.size()));
+        for (auto it = prod.rhs.rbegin(); it != prod.rhs.rend(); ++it) {
+            if (*it != EPSILON)
+                data.rhsSymbols.push_back(id[*it]);
+        }
+    }
+    data.rhsBegin.push_back(static_cast<uint16_t>(data.rhsSymbols.size()));
+
+    // Dense table, one row per nonterminal, packed below.
+    vector<int16_t> cells(nonTerminals.size() * terminals.size(), LL1_ERROR);
+    for (const auto &entry : parsingTable) {
+        auto nt = id.find(entry.first.first);
+        auto t = id.find(entry.first.second);
+        if (nt == id.end() || t == id.end())
+            continue;
+        int16_t &cell = cells[(nt->second - data.numTerminals) * data.numTerminals + t->second];
+        if (entry.second.size() == 1) {
+            cell = static_cast<int16_t>(entry.second[0]);
+        } else {
+            cell = LL1_CONFLICT;
+            string msg = "conflict in parsing table for (" + entry.first.first + ", " + entry.first.second + "):";
+            for (int p : entry.second)
+                msg += " " + to_string(p + 1);
+            data.conflicts.push_back(msg);
+        }
+    }
+
+    packRows(cells, terminals.size(), data.rowBase, data.entries);
+
+    // How each token type maps onto a terminal.
+    data.tokenTerminal.assign(TOKEN_TYPE_COUNT, -1);
+    for (size_t t = 0; t < TOKEN_TYPE_COUNT; t++) {
+        auto it = id.find(terminalForToken(static_cast<TokenType>(t)));
+        if (it != id.end() && it->second < data.numTerminals)
+            data.tokenTerminal[t] = static_cast<int16_t>(it->second);
+    }
+    return data;
+}
+
+template <class T>
+static bool sameArray(const char *what, const T *a, const T *b, size_t n, string &diff) {
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != b[i]) {
+            diff = string(what) + "[" + to_string(i) + "]: " + to_string(a[i]) + " vs " + to_string(b[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameLL1Table(const LL1Table &a, const LL1Table &b, string &diff) {
+    if (a.numTerminals != b.numTerminals || a.numSymbols != b.numSymbols ||
+        a.numProductions != b.numProductions || a.startSymbol != b.startSymbol ||
+        a.endTerminal != b.endTerminal) {
+        diff = "symbol or production counts differ";
+        return false;
+    }
+    for (size_t i = 0; i < a.numSymbols; i++) {
+        if (strcmp(a.symbolNames[i], b.symbolNames[i]) != 0) {
+            diff = "symbol " + to_string(i) + ": " + a.symbolNames[i] + " vs " + b.symbolNames[i];
+            return false;
+        }
+    }
+    for (uint16_t nt = a.numTerminals; nt < a.numSymbols; nt++) {
+        for (uint16_t t = 0; t < a.numTerminals; t++) {
+            if (a.cell(nt, t) != b.cell(nt, t)) {
+                diff = string("cell (") + a.symbolNames[nt] + ", " + a.symbolNames[t] + "): " +
+                       to_string(a.cell(nt, t)) + " vs " + to_string(b.cell(nt, t));
+                return false;
+            }
+        }
+    }
+    return 
+           sameArray("productionLhs", a.productionLhs, b.productionLhs, a.numProductions, diff) &&
+           sameArray("rhsBegin", a.rhsBegin, b.rhsBegin, a.numProductions + 1u, diff) &&
+           sameArray("rhsSymbols", a.rhsSymbols, b.rhsSymbols, a.rhsBegin[a.numProductions], diff) &&
+           sameArray("tokenTerminal", a.tokenTerminal, b.tokenTerminal, TOKEN_TYPE_COUNT, diff);
+}
@@ -0,0 +1,104 @@
+#ifndef LL1_TABLE_H
+#define LL1_TABLE_H
+
+#include "grammar.h"
+#include "token.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Cell values other than a production index.
+const int16_t LL1_ERROR = -1;      // No rule: syntax error.
+const int16_t LL1_CONFLICT = -2;   // More than one rule: the grammar is not LL(1).
+
+// One slot of the compressed parsing table: a cell value and the row
+// (nonterminal - numTerminals) it belongs to.
+struct LL1Entry {
+    uint16_t row;
+    int16_t value;
+};
+const uint16_t LL1_NO_ROW = UINT16_MAX;   // Unused slot.
+
+// Read-only LL(1) tables over small integer symbol IDs. Terminals take IDs
+// [0, numTerminals), nonterminals [numTerminals, numSymbols). The arrays
+// are not owned: they may live in an LL1TableData, in static data linked
+// into the binary, or in a mapped file.
+//
+// The parsing table is stored with row displacement: the rows are
+// overlaid in one `entries` array, row r starting at rowBase[r], so that
+// no two rows put a non-error cell in the same slot. Each slot records the
+// row it belongs to; a slot of any other row reads as LL1_ERROR. Most
+// cells are errors, so this is a small fraction of the dense table and a
+// lookup is still two loads and a compare.
+struct LL1Table {
+    uint16_t numTerminals;
+    uint16_t numSymbols;
+    uint16_t numProductions;
+    uint16_t startSymbol;            // <sql>
+    uint16_t endTerminal;            // "$"
+    uint32_t numEntries;             // At least rowBase[r] + numTerminals for every row.
+    const char *const *symbolNames;  // [numSymbols]
+    const uint32_t *rowBase;         // [nonterminal - numTerminals]
+    const LL1Entry *entries;         // [numEntries]
+    const uint16_t *productionLhs;   // [numProductions]
+    const uint16_t *rhsBegin;        // [numProductions + 1], offsets into rhsSymbols
+    const uint16_t *rhsSymbols;      // Each RHS reversed (push order), EPSILON left out.
+    const int16_t *tokenTerminal;    // [TokenType] -> terminal ID, -1 if none.
+
+    bool isTerminal(uint16_t sym) const { return sym < numTerminals; }
+    int16_t cell(uint16_t nonTerminal, uint16_t terminal) const {
+        uint16_t row = static_cast<uint16_t>(nonTerminal - numTerminals);
+        const LL1Entry &e = entries[rowBase[row] + terminal];
+        return e.row == row ? e.value : LL1_ERROR;
+    }
+    // Bytes taken by the parsing table (rowBase and entries).
+    size_t tableBytes() const {
+        return (numSymbols - numTerminals) * sizeof(uint32_t) + numEntries * sizeof(LL1Entry);
+    }
+};
+
+// Number of TokenType values (END is the last one).
+const size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::END) + 1;
+
+// Owning storage for an LL1Table compiled at run time.
+struct LL1TableData {
+    vector<string> symbols;
+    vector<const char *> symbolNames;
+    vector<uint32_t> rowBase;
+    vector<LL1Entry> entries;
+    vector<uint16_t> productionLhs;
+    vector<uint16_t> rhsBegin;
+    vector<uint16_t> rhsSymbols;
+    vector<int16_t> tokenTerminal;
+    uint16_t numTerminals = 0;
+    uint16_t startSymbol = 0;
+    uint16_t endTerminal = 0;
+    vector<string> conflicts;   // One message per cell with more than one rule.
+
+    // The view is only valid while this object is alive and unmodified.
+    LL1Table view() const;
+};
+
+// Assigns symbol IDs to the grammar and packs the parsing table built by
+// constructParsingTable() into rowBase/entries. Conflicting cells are
+// listed in `conflicts` and marked LL1_CONFLICT.
+LL1TableData compileLL1Table(const vector<Production>& grammar,
+                             const map<pair<string, string>, vector<int>> &parsingTable);
+
+// Tables generated from buildGrammar() at build time by tablegen
+// (ll1_builtin.cpp). Statically initialized: using them costs nothing at
+// startup.
+extern const LL1Table builtinLL1Table;
+
+// Compares two tables entry by entry; the parsing tables are compared cell
+// by cell, whatever their layout. On the first difference, returns false
+// and describes it in `diff`.
+bool sameLL1Table(const LL1Table &a, const LL1Table &b, string &diff);
+
+// The grammar terminal a token type is matched against ("id", "num", "str",
+// "$", or the keyword/symbol spelling), or "" for ERROR.
+string terminalForToken(TokenType type);
+
+#endif // LL1_TABLE_H
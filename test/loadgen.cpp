@@ -0,0 +1,154 @@
+// Load generator for the compile server (sql_parser --serve SOCKET).
+// Opens C connections, each sending N requests one at a time and waiting
+// for the response, and reports throughput and latency percentiles.
+// Usage: ./sql_loadgen SOCKET [--connections C] [--requests N] [--file F]
+// Requests are the non-empty lines of F, or generated SELECT and INSERT
+// statements of a few shapes with varying literals.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "protocol.h"
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+static vector<string> makeRequests(size_t count, unsigned seed) {
+    mt19937 rng(seed);
+    vector<string> out;
+    for (size_t i = 0; i < count; i++) {
+        switch (rng() % 3) {
+            case 0:
+                out.push_back("SELECT id, name FROM customers WHERE id = " + to_string(rng() % 100000) + ";");
+                break;
+            case 1:
+                out.push_back("INSERT INTO customers (id, name, balance) VALUES (" + to_string(rng() % 100000) +
+                              ", 'customer " + to_string(rng()) + "', " + to_string(rng() % 10000) + ");");
+                break;
+            default:
+                out.push_back("SELECT * FROM orders WHERE total BETWEEN " + to_string(rng() % 100) + " AND " +
+                              to_string(rng() % 100000) + ";");
+                break;
+        }
+    }
+    return out;
+}
+
+static int connectTo(const string &path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path)
+        return -1;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof addr) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static double percentile(const vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    size_t i = min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    return sorted[i];
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " SOCKET [--connections C] [--requests N] [--file F]" << endl;
+        return 1;
+    }
+    string path = argv[1];
+    size_t connections = 4, perConnection = 10000;
+    string file;
+    for (int a = 2; a + 1 < argc; a += 2) {
+        string arg = argv[a];
+        if (arg == "--connections")
+            connections = max(1ul, strtoul(argv[a + 1], nullptr, 10));
+        else if (arg == "--requests")
+            perConnection = strtoul(argv[a + 1], nullptr, 10);
+        else if (arg == "--file")
+            file = argv[a + 1];
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    vector<string> corpus;
+    if (!file.empty()) {
+        ifstream in(file);
+        if (!in) {
+            cerr << "Error: Unable to open file " << file << " for reading." << endl;
+            return 1;
+        }
+        for (string line; getline(in, line);) {
+            if (line.find_first_not_of(" \t\r") != string::npos)
+                corpus.push_back(line);
+        }
+    } else {
+        corpus = makeRequests(4096, 1);
+    }
+    if (corpus.empty()) {
+        cerr << "Error: no requests" << endl;
+        return 1;
+    }
+
+    vector<vector<double>> latencies(connections);
+    vector<size_t> errors(connections, 0), rejected(connections, 0);
+    Clock::time_point start = Clock::now();
+    vector<thread> threads;
+    for (size_t c = 0; c < connections; c++) {
+        threads.emplace_back([&, c]() {
+            int fd = connectTo(path);
+            if (fd < 0) {
+                errors[c]++;
+                return;
+            }
+            string response, error;
+            latencies[c].reserve(perConnection);
+            for (size_t r = 0; r < perConnection; r++) {
+                const string &sql = corpus[(c * 7919 + r) % corpus.size()];
+                Clock::time_point sent = Clock::now();
+                if (!writeFrame(fd, sql) || !readFrame(fd, response, error)) {
+                    errors[c]++;
+                    break;
+                }
+                latencies[c].push_back(chrono::duration<double, micro>(Clock::now() - sent).count());
+                if (response.compare(0, 2, "OK") != 0)
+                    rejected[c]++;
+            }
+            close(fd);
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<double> all;
+    size_t failed = 0, invalid = 0;
+    for (size_t c = 0; c < connections; c++) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        failed += errors[c];
+        invalid += rejected[c];
+    }
+    sort(all.begin(), all.end());
+    cout << all.size() << " requests on " << connections << " connections in " << seconds << " s ("
+         << all.size() / seconds << " req/s), " << invalid << " rejected" << endl;
+    cout << "latency us: p50 " << percentile(all, 0.50) << "  p90 " << percentile(all, 0.90)
+         << "  p99 " << percentile(all, 0.99) << "  max " << (all.empty() ? 0 : all.back()) << endl;
+    if (failed) {
+        cerr << "Error: " << failed << " connections failed" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,14 +1,381 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <new>
 #include <vector>
 #include "grammar.h"
 #include "token.h"
 #include "lexer.h"
 #include "parser.h"
 #include "utils.h"
-#include "parse_tree.h" 
+#include "parse_tree.h"
+#include "ast.h"
+#include "input.h"
+#include "parallel.h"
+#include "semantic.h"
+#include "server.h"
+#include "stats.h"
+#include "store.h"
+#include "table_cache.h"
+#include "token_ring.h"
 using namespace std;
 
-int main() {
+#ifndef SQL_NO_STATS
+// Counts heap allocations for --stats.
+void *operator new(size_t n) {
+    STATS_ADD(Counter::Allocations, 1);
+    STATS_ADD(Counter::AllocatedBytes, n);
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { free(p); }
+#endif
+
+// Prints the token table one token at a time, without collecting the
+// tokens. Works with any lexer that has nextToken().
+template <class TokenSource>
+static int printTokenStream(TokenSource &lexer) {
+    size_t count = 0;
+    size_t errors = 0;
+    cout << "=== Token Table ===" << endl;
+    for (Token tok = lexer.nextToken(); ; tok = lexer.nextToken()) {
+        cout << tok.lexeme << "\t(" << tokenName(tok.type) << ")" << '\n';
+        count++;
+        if (tok.type == TokenType::ERROR)
+            errors++;
+        if (tok.type == TokenType::END)
+            break;
+    }
+    cout << "===================" << endl;
+    cout << count << " tokens, " << errors << " lexical errors" << endl;
+    STATS_ADD(Counter::Tokens, count);
+    return errors ? 1 : 0;
+}
+
+// Parses while lexing: tokens go from the lexer to the LL(1) parser through
+// a TokenRing and are never collected, so memory does not grow with the
+// script and a syntax error stops the lexer as well.
+template <class Lex>
+static int parseFused(Lex &lexer, const LL1Table &table) {
+    TokenRing<Lex> ring(lexer);
+    vector<uint16_t> stack;
+    string error;
+    size_t peak = 0;
+    auto start = chrono::steady_clock::now();
+    bool ok;
+    {
+        STATS_PHASE(Phase::Parse);
+        // The stack holds the symbols below the one being matched.
+        ok = ll1Run(ring, table, stack, error, [&](const Token &) { peak = max(peak, stack.size() + 1); });
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    STATS_ADD(Counter::Tokens, ring.consumed());
+    if (!ok) {
+        const Token *tok = ring.current();
+        if (tok)
+            cerr << "Offset " << tok->offset << ": ";
+        cerr << error << endl;
+    } else {
+        cout << "Parsing successful: Input is syntactically correct according to the LL(1) grammar." << endl;
+    }
+    cout << ring.consumed() << " tokens, peak stack " << peak << ", " << seconds << " s" << endl;
+    return ok ? 0 : 1;
+}
+
+// Recomputes the LL(1) tables from the grammar (buildGrammar(), or the
+// grammar file), writes the grammar artifacts, and checks the result
+// against the tables in use: the built-in ones or the grammar's cache.
+static int verifyTables(const string &grammarPath, const LL1Table &inUse) {
+    vector<Production> grammar;
+    if (grammarPath.empty())
+        grammar = buildGrammar();
+    else if (!readCFGGrammarFile(grammarPath, grammar))
+        return 1;
+    generateCFGGrammarFile(grammar, "CFG_grammar.txt");
+    map<string, set<string>> first, follow;
+    {
+        STATS_PHASE(Phase::GrammarSets);
+        GrammarSets sets = computeGrammarSets(grammar);
+        first = firstSetsAsMap(sets);
+        follow = followSetsAsMap(sets);
+    }
+    map<pair<string, string>, vector<int>> parsingTable;
+    LL1TableData table;
+    {
+        STATS_PHASE(Phase::TableBuild);
+        parsingTable = constructParsingTable(grammar, first, follow);
+        table = compileLL1Table(grammar, parsingTable);
+    }
+    writeParsingInfoToFile(grammar, first, follow, parsingTable);
+    for (const auto &c : table.conflicts)
+        cerr << "Warning: " << c << endl;
+
+    string diff;
+    if (!sameLL1Table(table.view(), inUse, diff)) {
+        if (grammarPath.empty())
+            cerr << "Error: built-in LL(1) tables are out of date (" << diff
+                 << "); rerun tablegen (see run.txt)." << endl;
+        else
+            cerr << "Error: cached LL(1) tables for " << grammarPath << " do not match the grammar ("
+                 << diff << "); delete " << grammarPath << ".ll1 to rebuild them." << endl;
+        return 1;
+    }
+    cout << (grammarPath.empty() ? "Built-in" : "Cached") << " LL(1) tables match the grammar." << endl;
+    return 0;
+}
+
+// Validates the whole script on `jobs` threads and prints the syntax errors
+// in source order, without the token table or the grammar artifacts. With
+// `printStatements`, also builds the AST of every valid statement and prints
+// it as normalized SQL. With `check`, also runs the semantic pass over the
+// valid statements, in order, against a catalog built from their CREATE
+// TABLE statements, and reports its errors among the syntax errors. With
+// `exec`, also executes the statements that pass it against a ColumnStore
+// and prints the results of their SELECTs.
+template <class Table>
+static int validateScript(string_view input, const Table &table, unsigned jobs, bool printStatements,
+                          bool check, bool exec, size_t cacheEntries) {
+    ThreadPool pool(jobs);
+    vector<Ast> asts;
+    auto start = chrono::steady_clock::now();
+    ValidationResult result;
+    {
+        STATS_PHASE(Phase::Validate);
+        result = validateParallel(input, table, pool, 1 << 20, printStatements || check ? &asts : nullptr,
+                                  cacheEntries);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (printStatements) {
+        for (const auto &ast : asts)
+            printAst(cout, ast);
+    }
+
+    size_t syntaxErrors = result.errors.size();
+    Catalog catalog;
+    ColumnStore store(catalog);
+    vector<StatementError> semanticErrors;
+    size_t executionErrors = 0;
+    double checkSeconds = 0;
+    double execSeconds = 0;
+    if (check) {
+        SemanticAnalyzer analyzer(catalog);
+        Resolution resolution;
+        for (const auto &ast : asts) {
+            auto checkStart = chrono::steady_clock::now();
+            analyzer.analyze(ast, resolution, semanticErrors);
+            auto execStart = chrono::steady_clock::now();
+            checkSeconds += chrono::duration<double>(execStart - checkStart).count();
+            if (exec) {
+                executionErrors += store.execute(ast, resolution, cout, semanticErrors);
+                execSeconds += chrono::duration<double>(chrono::steady_clock::now() - execStart).count();
+            }
+        }
+        // Each Ast's execution errors follow its semantic errors.
+        if (executionErrors)
+            stable_sort(semanticErrors.begin(), semanticErrors.end(),
+                        [](const StatementError &a, const StatementError &b) { return a.offset < b.offset; });
+        vector<StatementError> errors;
+        errors.reserve(syntaxErrors + semanticErrors.size());
+        merge(make_move_iterator(result.errors.begin()), make_move_iterator(result.errors.end()),
+              make_move_iterator(semanticErrors.begin()), make_move_iterator(semanticErrors.end()),
+              back_inserter(errors),
+              [](const StatementError &a, const StatementError &b) { return a.offset < b.offset; });
+        result.errors.swap(errors);
+    }
+
+    // Errors are sorted, so line numbers can be counted in one pass.
+    size_t line = 1;
+    size_t counted = 0;
+    for (const auto &e : result.errors) {
+        line += count(input.begin() + counted, input.begin() + e.offset, '\n');
+        counted = e.offset;
+        cerr << "Line " << line << " (offset " << e.offset << "): " << e.message << endl;
+    }
+    cout << result.statements << " statements, " << syntaxErrors << " with errors, "
+         << pool.size() << " threads, " << seconds << " s ("
+         << input.size() / seconds / 1e6 << " MB/s)" << endl;
+    if (check)
+        cout << semanticErrors.size() - executionErrors << " with semantic errors, " << catalog.tableCount()
+             << " tables, " << catalog.columnCount() << " columns, " << checkSeconds << " s" << endl;
+    if (exec)
+        cout << store.statementsExecuted() << " executed, " << executionErrors << " failed, " << store.totalRows()
+             << " rows stored (" << store.dataBytes() / 1024 << " KB, " << store.indexBytes() / 1024
+             << " KB of key indexes), " << store.rowsReturned()
+             << " rows returned, " << execSeconds << " s" << endl;
+    if (cacheEntries)
+        cout << "parse cache: " << result.cacheHits << " hits, " << result.cacheMisses << " misses" << endl;
+    return result.errors.empty() ? 0 : 1;
+}
+
+// Prints the --stats report on stderr when main returns, whichever way it
+// does; everything main starts has finished by then.
+struct StatsReport {
+    enum Format { Off, Table, Json } format = Off;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    ~StatsReport() {
+        if (format == Off)
+            return;
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (format == Json)
+            printStatsJson(cerr, collectStats(), seconds);
+        else
+            printStats(cerr, collectStats(), seconds);
+    }
+};
+
+static void printUsage(const char *prog) {
+    cerr << "Usage: " << prog << " [--grammar FILE] [--engine ll1|lalr] [--file PATH] [--tokens | --fused | --jobs N [--ast] [--check | --exec | --serve SOCKET|-] [--cache N] | --verify-tables] [--stats[=json]]" << endl;
+    cerr << "  --grammar FILE  parse with the grammar in FILE (CFG_grammar.txt format) instead of" << endl;
+    cerr << "                the built-in one; its tables are cached in FILE.ll1" << endl;
+    cerr << "  --engine E    parser engine: ll1 (default, built-in or cached tables) or lalr" << endl;
+    cerr << "                (LALR(1) tables built at startup; the grammar need not be LL(1))" << endl;
+    cerr << "  --file PATH   read the whole script from PATH (memory-mapped; '-' reads stdin)" << endl;
+    cerr << "  --tokens      print the token table and stop; without --file, stdin is" << endl;
+    cerr << "                streamed in chunks instead of being read up to a blank line" << endl;
+    cerr << "  --fused       only validate, lexing and parsing in one pass without storing" << endl;
+    cerr << "                the tokens (LL(1) engine); without --file, stdin is streamed" << endl;
+    cerr << "  --jobs N      only validate the script, statement by statement, on N threads" << endl;
+    cerr << "                (0 = one per core); without --file, all of stdin is read" << endl;
+    cerr << "  --ast         with --jobs, print the AST of each valid statement as SQL" << endl;
+    cerr << "  --check       with --jobs, also check the valid statements against the tables" << endl;
+    cerr << "                their CREATE TABLE statements declare (names, value counts, types)" << endl;
+    cerr << "  --exec        with --jobs, --check and then execute the valid statements against" << endl;
+    cerr << "                an in-memory column store, printing the rows each SELECT returns" << endl;
+    cerr << "  --cache N     with --jobs or --serve, keep up to N statement shapes per thread" << endl;
+    cerr << "                and skip parsing statements that differ from one only in literals" << endl;
+    cerr << "  --serve S     compile server: answer length-prefixed SQL requests on the Unix" << endl;
+    cerr << "                socket S, or on stdin/stdout for '-', on --jobs threads (see protocol.h)" << endl;
+    cerr << "  --verify-tables  recompute FIRST/FOLLOW and the parsing table, write" << endl;
+    cerr << "                CFG_grammar.txt and parsing_table.txt, and compare with" << endl;
+    cerr << "                the tables in use" << endl;
+    cerr << "  --stats       on exit, print time per phase and parser counters to stderr as a" << endl;
+    cerr << "                table, or as JSON with --stats=json (not in -DSQL_NO_STATS builds)" << endl;
+}
+
+int main(int argc, char **argv) {
+    bool tokensOnly = false;
+    bool fused = false;
+    int jobs = -1;      // >= 0 selects parallel validation.
+    bool printStatements = false;
+    bool check = false;
+    bool exec = false;
+    size_t cacheEntries = 0;
+    string servePath;
+    bool verify = false;
+    bool useLalr = false;
+    string path;
+    string grammarPath;
+    StatsReport stats;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if ((arg == "--stats" || arg == "--stats=json") && STATS_ENABLED) {
+            stats.format = arg == "--stats" ? StatsReport::Table : StatsReport::Json;
+        } else if (arg == "--stats" || arg == "--stats=json") {
+            cerr << "Error: built without statistics (SQL_NO_STATS)" << endl;
+            return 1;
+        } else if (arg == "--tokens") {
+            tokensOnly = true;
+        } else if (arg == "--fused") {
+            fused = true;
+        } else if (arg == "--ast") {
+            printStatements = true;
+        } else if (arg == "--check") {
+            check = true;
+        } else if (arg == "--exec") {
+            check = exec = true;
+        } else if (arg == "--verify-tables") {
+            verify = true;
+        } else if (arg == "--engine" && a + 1 < argc && (string(argv[a + 1]) == "ll1" || string(argv[a + 1]) == "lalr")) {
+            useLalr = string(argv[++a]) == "lalr";
+        } else if (arg == "--grammar" && a + 1 < argc) {
+            grammarPath = argv[++a];
+        } else if (arg == "--file" && a + 1 < argc) {
+            path = argv[++a];
+        } else if (arg == "--serve" && a + 1 < argc) {
+            servePath = argv[++a];
+        } else if (arg == "--cache" && a + 1 < argc) {
+            cacheEntries = strtoul(argv[++a], nullptr, 10);
+        } else if (arg == "--jobs" && a + 1 < argc) {
+            jobs = static_cast<int>(strtol(argv[++a], nullptr, 10));
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (((fused || !servePath.empty()) && useLalr) || (check && (jobs < 0 || !servePath.empty()))) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // The LALR(1) engine compiles its tables from the grammar at startup.
+    LALRTableData lalrTables;
+    if (useLalr && !verify) {
+        vector<Production> grammar;
+        if (grammarPath.empty())
+            grammar = buildGrammar();
+        else if (!readCFGGrammarFile(grammarPath, grammar))
+            return 1;
+        STATS_PHASE(Phase::TableBuild);
+        lalrTables = compileLALRTable(grammar);
+        if (!lalrTables.conflicts.empty()) {
+            for (const auto &c : lalrTables.conflicts)
+                cerr << "Error: " << c << endl;
+            return 1;
+        }
+    }
+
+    // The built-in tables, or the cached tables of the --grammar file.
+    const LL1Table *table = &builtinLL1Table;
+    GrammarTables grammarTables;
+    if (!grammarPath.empty() && (!useLalr || verify)) {
+        STATS_PHASE(Phase::TableBuild);
+        if (!grammarTables.load(grammarPath))
+            return 1;
+        if (!grammarTables.fromCache())
+            cerr << "Note: compiled " << grammarPath << "; tables cached in " << grammarTables.cachePath() << endl;
+        table = &grammarTables.table();
+    }
+    if (verify)
+        return verifyTables(grammarPath, *table);
+    if (servePath == "-")
+        return serveStream(0, 1, *table, jobs > 0 ? static_cast<unsigned>(jobs) : 0, cacheEntries);
+    if (!servePath.empty())
+        return serveSocket(servePath, *table, jobs > 0 ? static_cast<unsigned>(jobs) : 0, cacheEntries);
+
+    InputFile file;
+    if (jobs >= 0 && path.empty())
+        path = "-";
+    if (!path.empty() && !file.open(path))
+        return 1;
+    if (jobs >= 0 && useLalr)
+        return validateScript(file.data(), lalrTables.view(), static_cast<unsigned>(jobs), printStatements,
+                              check, exec, cacheEntries);
+    if (jobs >= 0)
+        return validateScript(file.data(), *table, static_cast<unsigned>(jobs), printStatements, check,
+                              exec, cacheEntries);
+    if (fused) {
+        if (path.empty()) {
+            StreamLexer lexer(cin);
+            return parseFused(lexer, *table);
+        }
+        Lexer lexer(file.data());
+        return parseFused(lexer, *table);
+    }
+    if (tokensOnly) {
+        if (path.empty()) {
+            StreamLexer lexer(cin);
+            return printTokenStream(lexer);
+        }
+        Lexer lexer(file.data());
+        return printTokenStream(lexer);
+    }
+
     // Print the CFG for reference.
     cout << "=== Context-Free Grammar (CFG) for Simplified SQL ===" << endl;
     cout << R"CFG(
@@ -20,7 +387,7 @@ int main() {
 <insert_stmt>  ::= "INSERT" "INTO" <identifier> [ "(" <identifier_list> ")" ] "VALUES" "(" <value_list> ")"
 <identifier_list>    ::= <identifier> { "," <identifier> }
 <value_list>         ::= <value> { "," <value> }
-<select_stmt>  ::= "SELECT" <select_list> "FROM" <identifier> [ <where_clause> ] ";"
+<select_stmt>  ::= "SELECT" <select_list> "FROM" <identifier> [ <where_clause> ]
 <select_list>  ::= "*" | <identifier_list>
 <where_clause> ::= "WHERE" <condition>
 <condition>    ::= <identifier> <comp_operator> <value>
@@ -35,15 +402,24 @@ int main() {
 <string>       ::= str
 )CFG" << endl;
     
-    cout << "Enter SQL query (end with an empty line):" << endl;
-    string input, line;
-    while(getline(cin, line)) {
-        if(line.empty()) break;
-        input += line + "\n";
+    string typed;
+    string_view input;
+    if (path.empty()) {
+        cout << "Enter SQL query (end with an empty line):" << endl;
+        string line;
+        while(getline(cin, line)) {
+            if(line.empty()) break;
+            typed += line + "\n";
+        }
+        input = typed;
+    } else {
+        input = file.data();
     }
     
-    // Lexical Analysis: Tokenize the input SQL query.
+    // Lexical Analysis: Tokenize the input SQL query, interning names and
+    // literals for the symbol table.
     Lexer lexer(input);
+    lexer.setInterning(Interning::All);
     vector<Token> tokens = lexer.tokenize();
     
     cout << "\n=== Token Table ===" << endl;
@@ -52,17 +428,30 @@ int main() {
     }
     cout << "===================\n\n";
     
-    // Build the grammar and compute FIRST, FOLLOW, and the LL(1) parsing table.
-    vector<Production> grammar = buildGrammar();
-    generateCFGGrammarFile(grammar, "CFG_grammar.txt");
-    auto first = computeFirstSets(grammar);
-    auto follow = computeFollowSets(grammar, first);
-    auto parsingTable = constructParsingTable(grammar, first, follow);
-    writeParsingInfoToFile(grammar, first, follow, parsingTable);
     generateSymbolTableFile(tokens,"symtab.txt");
-    // Perform syntax analysis using the LL(1) parsing table.
+    if (useLalr) {
+        cout << "\n=== LALR(1) Parsing (Using Action/Goto Tables) ===" << endl;
+        STATS_PHASE(Phase::Parse);
+        lalrParse(tokens, lalrTables.view());
+        return 0;
+    }
+    // Perform syntax analysis using the built-in (or --grammar) LL(1) parsing table
+    // (run with --verify-tables to recompute it and write the artifacts).
     cout << "\n=== LL(1) Parsing (Using Parsing Table) ===" << endl;
-    ll1Parse(tokens, grammar, parsingTable);
+    ParseArena arena;
+    vector<uint32_t> stack;
+    string error;
+    int64_t root;
+    {
+        STATS_PHASE(Phase::Parse);
+        root = ll1ParseTree(tokens.data(), tokens.size(), *table, arena, stack, error);
+    }
+    if (root < 0) {
+        cerr << error << endl;
+    } else {
+        cout << "Parsing successful: Input is syntactically correct according to the LL(1) grammar." << endl;
+        writeParseTreeFile(arena, static_cast<uint32_t>(root), tokens.data(), *table, "parse_tree.txt");
+    }
     
     return 0;
 }
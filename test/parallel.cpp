@@ -0,0 +1,163 @@
+#include "parallel.h"
+#include "ast.h"
+#include "lexer.h"
+#include "parse_cache.h"
+#include "parser.h"
+#include "scan.h"
+#include "stats.h"
+using namespace std;
+
+vector<size_t> splitIntoBatches(string_view input, size_t batchBytes) {
+    vector<size_t> ends;
+    const char *s = input.data();
+    size_t n = input.size();
+    size_t start = 0;
+    size_t pos = 0;
+    for (;;) {
+        pos = findStatementBreak(s, pos, n);
+        if (pos >= n)
+            break;
+        if (s[pos] == ';') {
+            pos++;
+            if (pos - start >= batchBytes) {
+                ends.push_back(pos);
+                start = pos;
+            }
+        } else {
+            // Skip the quoted string. A doubled quote just closes the
+            // literal and reopens it, exactly as the lexer sees it.
+            size_t close = findByte(s, pos + 1, n, s[pos]);
+            if (close >= n)
+                break;  // Unterminated: the rest belongs to the last batch.
+            pos = close + 1;
+        }
+    }
+    if (ends.empty() || ends.back() != n)
+        ends.push_back(n);
+    return ends;
+}
+
+// Checks one statement with either engine, adding it to `ast` if it is
+// not null and the statement is valid.
+static bool checkStatement(const Token *tokens, size_t count, const LL1Table &table,
+                           vector<uint16_t> &stack, string &error, Ast *ast) {
+    return ast ? ll1Build(tokens, count, table, stack, error, *ast)
+               : ll1Check(tokens, count, table, stack, error);
+}
+
+static bool checkStatement(const Token *tokens, size_t count, const LALRTable &table,
+                           vector<uint16_t> &stack, string &error, Ast *ast) {
+    return ast ? lalrBuild(tokens, count, table, stack, error, *ast)
+               : lalrCheck(tokens, count, table, stack, error);
+}
+
+// checkStatement() through `cache`, if it is not null: a statement whose
+// shape the cache holds is accepted without parsing and its AST is bound
+// from the cached one; otherwise it is parsed into scratch.statement and
+// cached if it is valid.
+template <class Table>
+static bool checkCached(const Token *tokens, size_t count, const Table &table, ValidationScratch &scratch,
+                        Ast *ast, ParseCache *cache) {
+    if (!cache)
+        return checkStatement(tokens, count, table, scratch.stack, scratch.error, ast);
+    uint64_t fp = statementFingerprint(tokens, count);
+    if (const Ast *cached = cache->find(fp, count)) {
+        if (ast)
+            appendStatement(*ast, *cached, tokens, count);
+        return true;
+    }
+    scratch.statement.clear();
+    if (!checkStatement(tokens, count, table, scratch.stack, scratch.error, &scratch.statement))
+        return false;
+    if (ast)
+        appendStatement(*ast, scratch.statement, tokens, count);
+    cache->insert(fp, count, move(scratch.statement));
+    return true;
+}
+
+// Lexes input[begin, end) and checks each of its statements on its own,
+// adding the accepted ones to `ast` if it is not null.
+template <class Table>
+static void validateBatch(string_view input, size_t begin, size_t end, const Table &table,
+                          ValidationScratch &scratch, ValidationResult &result, Ast *ast,
+                          ParseCache *cache) {
+    // Names are interned once, at lex time, for the AST and the cache.
+    scratch.lexer.setInterning(ast || cache ? Interning::Identifiers : Interning::None);
+    scratch.lexer.reset(input.substr(begin, end - begin), begin);
+    scratch.lexer.tokenize(scratch.tokens);
+    const vector<Token> &tokens = scratch.tokens;
+    STATS_PHASE(Phase::Parse);
+    size_t first = 0;  // First token of the current statement.
+    for (size_t i = 0; i < tokens.size(); i++) {
+        TokenType type = tokens[i].type;
+        if (type != TokenType::SEMICOLON && type != TokenType::END)
+            continue;
+        if (type == TokenType::END && i == first)
+            break;  // Only whitespace after the last ';'.
+        result.statements++;
+        size_t count = i - first + (type == TokenType::SEMICOLON ? 1 : 0);
+        if (!checkCached(&tokens[first], count, table, scratch, ast, cache))
+            result.errors.push_back({tokens[first].offset, scratch.error});
+        first = i + 1;
+    }
+}
+
+template <class Table>
+static ValidationResult validateWith(string_view input, const Table &table, ThreadPool &pool,
+                                     size_t batchBytes, vector<Ast> *asts, size_t cacheEntries) {
+    vector<size_t> ends = splitIntoBatches(input, batchBytes);
+    if (asts) {
+        asts->clear();
+        asts->resize(ends.size());
+    }
+    vector<ValidationResult> partial(ends.size());
+    vector<ValidationScratch> scratch(pool.size());   // Per worker.
+    vector<ParseCache> caches;                      // Parse cache per worker.
+    if (cacheEntries)
+        caches.assign(pool.size(), ParseCache(cacheEntries));
+    pool.parallelFor(ends.size(), [&](size_t b, unsigned worker) {
+        size_t begin = b ? ends[b - 1] : 0;
+        validateBatch(input, begin, ends[b], table, scratch[worker], partial[b],
+                      asts ? &(*asts)[b] : nullptr, cacheEntries ? &caches[worker] : nullptr);
+    });
+
+    // Batches are in source order and each batch's errors already are.
+    ValidationResult merged;
+    for (const auto &c : caches) {
+        merged.cacheHits += c.hits();
+        merged.cacheMisses += c.misses();
+    }
+    for (auto &r : partial) {
+        merged.statements += r.statements;
+        for (auto &e : r.errors)
+            merged.errors.push_back(move(e));
+    }
+    return merged;
+}
+
+ValidationResult validateParallel(string_view input, const LL1Table &table, ThreadPool &pool,
+                                  size_t batchBytes, vector<Ast> *asts, size_t cacheEntries) {
+    return validateWith(input, table, pool, batchBytes, asts, cacheEntries);
+}
+
+ValidationResult validateParallel(string_view input, const LALRTable &table, ThreadPool &pool,
+                                  size_t batchBytes, vector<Ast> *asts, size_t cacheEntries) {
+    return validateWith(input, table, pool, batchBytes, asts, cacheEntries);
+}
+
+ValidationResult validateSerial(string_view input, const LL1Table &table, ValidationScratch &scratch,
+                                Ast *ast, ParseCache *cache) {
+    ValidationResult result;
+    validateSerial(input, table, scratch, result, ast, cache);
+    return result;
+}
+
+void validateSerial(string_view input, const LL1Table &table, ValidationScratch &scratch,
+                    ValidationResult &result, Ast *ast, ParseCache *cache) {
+    result.statements = 0;
+    result.errors.clear();
+    size_t hits = cache ? cache->hits() : 0, misses = cache ? cache->misses() : 0;
+    validateBatch(input, 0, input.size(), table, scratch, result, ast, cache);
+    result.cacheHits = cache ? cache->hits() - hits : 0;
+    result.cacheMisses = cache ? cache->misses() - misses : 0;
+}
@@ -0,0 +1,66 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "ast.h"
+#include "lalr.h"
+#include "lexer.h"
+#include "ll1_table.h"
+#include "parse_cache.h"
+#include "thread_pool.h"
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// Parallel validation of large scripts. <sql> is a sequence of independent
+// `<statement> ";"` items, so the script is cut into batches at top-level
+// semicolons, each batch is lexed and its statements are parsed on a worker
+// thread, and the errors are merged back in source order.
+
+struct StatementError {
+    size_t offset;      // Byte offset of the statement's first token.
+    string message;
+};
+
+struct ValidationResult {
+    size_t statements = 0;
+    vector<StatementError> errors;   // Sorted by offset.
+    size_t cacheHits = 0;            // Statements accepted from the parse cache.
+    size_t cacheMisses = 0;
+};
+
+// Splits `input` into ranges of roughly `batchBytes` bytes that end just
+// after a top-level ';' (semicolons inside quoted strings do not count).
+// Returns the end offset of each range; the last one is input.size().
+vector<size_t> splitIntoBatches(string_view input, size_t batchBytes);
+
+// With `asts`, also builds one Ast per batch, in source order, holding the
+// batch's valid statements. The table selects the parser engine. With
+// `cacheEntries` > 0, each worker keeps a ParseCache of that many statement
+// shapes and only parses statements whose shape it has not accepted yet.
+ValidationResult validateParallel(string_view input, const LL1Table &table,
+                                  ThreadPool &pool, size_t batchBytes = 1 << 20,
+                                  vector<Ast> *asts = nullptr, size_t cacheEntries = 0);
+ValidationResult validateParallel(string_view input, const LALRTable &table,
+                                  ThreadPool &pool, size_t batchBytes = 1 << 20,
+                                  vector<Ast> *asts = nullptr, size_t cacheEntries = 0);
+
+// Per-thread working state of validation. Reused across calls, it lets a
+// warmed-up thread validate without allocating.
+struct ValidationScratch {
+    Lexer lexer{string_view()};
+    vector<Token> tokens;
+    vector<uint16_t> stack;
+    Ast statement;      // Cache misses are parsed into this.
+    string error;
+};
+
+// Validates all of `input` on the calling thread, appending the valid
+// statements to `ast` if it is not null and going through `cache` (whose
+// counters it updates) if that is not null.
+ValidationResult validateSerial(string_view input, const LL1Table &table, ValidationScratch &scratch,
+                                Ast *ast = nullptr, ParseCache *cache = nullptr);
+void validateSerial(string_view input, const LL1Table &table, ValidationScratch &scratch,
+                    ValidationResult &result, Ast *ast = nullptr, ParseCache *cache = nullptr);
+
+#endif // PARALLEL_H
@@ -0,0 +1,74 @@
+#include "parse_cache.h"
+using namespace std;
+
+uint64_t statementFingerprint(const Token *tokens, size_t count) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < count; i++) {
+        TokenType type = tokens[i].type;
+        h = (h ^ static_cast<uint64_t>(type)) * 1099511628211ull;
+        if (type == TokenType::IDENTIFIER && tokens[i].symbol != NO_SYMBOL) {
+            h = (h ^ tokens[i].symbol) * 1099511628211ull;
+        } else if (type == TokenType::IDENTIFIER || type == TokenType::ERROR) {
+            for (unsigned char c : tokens[i].lexeme)
+                h = (h ^ c) * 1099511628211ull;
+            h = (h ^ 0xff) * 1099511628211ull;   // End of the name.
+        }
+    }
+    return h;
+}
+
+ParseCache::ParseCache(size_t capacity) : limit(capacity ? capacity : 1) {
+    entries.reserve(limit);
+    index.reserve(limit);
+}
+
+void ParseCache::unlink(uint32_t e) {
+    Entry &entry = entries[e];
+    (entry.prev == NONE ? head : entries[entry.prev].next) = entry.next;
+    (entry.next == NONE ? tail : entries[entry.next].prev) = entry.prev;
+}
+
+void ParseCache::pushFront(uint32_t e) {
+    entries[e].prev = NONE;
+    entries[e].next = head;
+    (head == NONE ? tail : entries[head].prev) = e;
+    head = e;
+}
+
+const Ast *ParseCache::find(uint64_t fp, size_t count) {
+    auto it = index.find(fp);
+    if (it == index.end() || entries[it->second].tokenCount != count) {
+        missCount++;
+        return nullptr;
+    }
+    hitCount++;
+    uint32_t e = it->second;
+    if (e != head) {
+        unlink(e);
+        pushFront(e);
+    }
+    return &entries[e].statement;
+}
+
+void ParseCache::insert(uint64_t fp, size_t count, Ast statement) {
+    auto it = index.find(fp);
+    uint32_t e;
+    if (it != index.end()) {
+        e = it->second;     // A collision on the token count: replace it.
+        unlink(e);
+    } else if (entries.size() < limit) {
+        e = static_cast<uint32_t>(entries.size());
+        entries.push_back({});
+        index[fp] = e;
+    } else {
+        e = tail;           // Reuse the least recently used entry.
+        unlink(e);
+        index.erase(entries[e].fingerprint);
+        index[fp] = e;
+    }
+    Entry &entry = entries[e];
+    entry.fingerprint = fp;
+    entry.tokenCount = count;
+    entry.statement = move(statement);
+    pushFront(e);
+}
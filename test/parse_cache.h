@@ -0,0 +1,61 @@
+#ifndef PARSE_CACHE_H
+#define PARSE_CACHE_H
+
+#include "ast.h"
+#include "token.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// Statement shapes. Scripts repeat the same SELECT and INSERT with
+// different literals; whether a statement parses, and its AST apart from
+// the literal texts, depend only on its token types and identifier names.
+// A statement's fingerprint hashes exactly that, so statements that differ
+// only in their NUMBER/STRING literals share one.
+
+// 64-bit FNV-1a fingerprint of tokens[0, count): the token types, with the
+// symbol of IDENTIFIER tokens (or their text, if not interned) and the text
+// of ERROR tokens; literal texts are left out. Tokens should come from
+// lexers with the same Interning, or equal statements may differ.
+uint64_t statementFingerprint(const Token *tokens, size_t count);
+
+// Bounded LRU map from fingerprints to the AST of a statement that parsed,
+// used as a template: on a hit the parser is skipped and the template is
+// bound to the statement's literals with appendStatement(). Only accepted
+// statements are cached. Not thread-safe; use one cache per thread.
+class ParseCache {
+public:
+    explicit ParseCache(size_t capacity = 4096);
+
+    // The template for a statement of `count` tokens with fingerprint `fp`,
+    // or null. Counts a hit or a miss and marks the entry most recent.
+    const Ast *find(uint64_t fp, size_t count);
+    // Adds a template, evicting the least recently used entry when full.
+    void insert(uint64_t fp, size_t count, Ast statement);
+
+    size_t size() const { return index.size(); }
+    size_t capacity() const { return limit; }
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    struct Entry {
+        uint64_t fingerprint;
+        size_t tokenCount;      // Guards against fingerprint collisions.
+        Ast statement;
+        uint32_t prev, next;    // Recency list, most recent first.
+    };
+
+    void unlink(uint32_t e);
+    void pushFront(uint32_t e);
+
+    size_t limit;
+    vector<Entry> entries;
+    unordered_map<uint64_t, uint32_t> index;
+    uint32_t head = NONE, tail = NONE;
+    size_t hitCount = 0, missCount = 0;
+};
+
+#endif // PARSE_CACHE_H
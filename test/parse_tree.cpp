@@ -0,0 +1,114 @@
+#include "parse_tree.h"
+#include "parser.h"
+#include "stats.h"
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+int64_t ll1ParseTree(const Token *tokens, size_t count, const LL1Table &table,
+                     ParseArena &arena, vector<uint32_t> &stack, string &error) {
+    ParseCounters<vector<uint32_t>> counters(stack);
+    uint32_t root = arena.allocate(1);
+    arena[root] = {table.startSymbol, -1, 0, 0, 0, 0};
+    stack.clear();
+    stack.push_back(root);
+    counters.pushed(1);
+
+    size_t i = 0;  // Token stream index.
+    auto terminalAt = [&](size_t k) -> int {
+        return k < count ? table.tokenTerminal[static_cast<size_t>(tokens[k].type)] : table.endTerminal;
+    };
+    int term = terminalAt(0);
+
+    while (!stack.empty()) {
+        uint32_t node = stack.back();
+        uint16_t top = arena[node].symbol;
+        arena[node].firstToken = static_cast<uint32_t>(i);
+        if (table.isTerminal(top)) {
+            if (top != term) {
+                error = expectedError(tokens, count, i, table, top);
+                counters.flush();
+                return -1;
+            }
+            arena[node].tokenCount = 1;
+            stack.pop_back();
+            term = terminalAt(++i);
+            continue;
+        }
+        counters.lookup();
+        int16_t prod = term < 0 ? LL1_ERROR : table.cell(top, static_cast<uint16_t>(term));
+        if (prod < 0) {
+            error = noRuleError(tokens, count, i, table, top, prod);
+            counters.flush();
+            return -1;
+        }
+        // One block for all the children. The RHS span is reversed, so the
+        // j-th symbol of the span is the (k-1-j)-th child, and pushing the
+        // span in order leaves the leftmost child on top of the stack.
+        stack.pop_back();
+        const uint16_t *rhs = table.rhsSymbols + table.rhsBegin[prod];
+        uint32_t k = table.rhsBegin[prod + 1] - table.rhsBegin[prod];
+        uint32_t first = arena.allocate(k);
+        arena[node].production = prod;
+        arena[node].firstChild = first;
+        arena[node].childCount = k;
+        for (uint32_t j = 0; j < k; j++) {
+            uint32_t child = first + k - 1 - j;
+            arena[child] = {rhs[j], -1, 0, 0, 0, 0};
+            stack.push_back(child);
+        }
+        counters.pushed(k);
+    }
+
+    counters.flush();
+    if (term != table.endTerminal) {
+        error = expectedError(tokens, count, i, table, table.endTerminal);
+        return -1;
+    }
+
+    // Nonterminal spans end where their last child ends. Children always
+    // come after their parent in the arena, so one backward pass suffices.
+    for (uint32_t n = static_cast<uint32_t>(arena.size()); n-- > root;) {
+        ParseNode &p = arena[n];
+        if (!table.isTerminal(p.symbol) && p.childCount > 0) {
+            const ParseNode &last = arena[p.firstChild + p.childCount - 1];
+            p.tokenCount = last.firstToken + last.tokenCount - p.firstToken;
+        }
+    }
+    return root;
+}
+
+void printParseTree(ostream &out, const ParseArena &arena, uint32_t root,
+                    const Token *tokens, const LL1Table &table) {
+    // Explicit stack of (node, depth): <sql_tail> nests once per statement,
+    // too deep for recursion on large scripts.
+    vector<pair<uint32_t, int>> pending = {{root, 0}};
+    while (!pending.empty()) {
+        auto [n, depth] = pending.back();
+        pending.pop_back();
+        const ParseNode &node = arena[n];
+        string indent(depth * 2, ' ');
+        out << indent << table.symbolNames[node.symbol];
+        if (table.isTerminal(node.symbol))
+            out << " [\"" << tokens[node.firstToken].lexeme << "\"]";
+        out << '\n';
+        if (!table.isTerminal(node.symbol) && node.childCount == 0)
+            out << indent << "  ε\n";
+        for (uint32_t c = node.childCount; c-- > 0;)
+            pending.push_back({node.firstChild + c, depth + 1});
+    }
+}
+
+void writeParseTreeFile(const ParseArena &arena, uint32_t root, const Token *tokens,
+                        const LL1Table &table, const string &filename) {
+    STATS_PHASE(Phase::WriteParseTree);
+    ofstream outFile(filename);
+    if (!outFile) {
+        cerr << "Error: Unable to open file " << filename << " for writing." << endl;
+        return;
+    }
+    outFile << "=== LL(1) Parse Tree ===" << endl << endl;
+    printParseTree(outFile, arena, root, tokens, table);
+    outFile << endl << "=====================" << endl;
+    cout << "Parse tree has been written to " << filename << endl;
+}
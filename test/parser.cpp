@@ -2,65 +2,51 @@
 #include <iostream>
 using namespace std;
 
-void ll1Parse(const vector<Token>& tokens, const vector<Production>& grammar,
-              const map<pair<string, string>, vector<int>> &parsingTable) {
-    // Initialize a stack with end-marker "$" and the start symbol.
-    vector<string> stack;
-    stack.push_back("$");
-    stack.push_back("<sql>");
-    
-    int i = 0;  // Token stream index.
-    
-    while (!stack.empty()) {
-        string top = stack.back();
-        // Map current token to the grammar's terminal representation.
-        string inputSymbol;
-        if (tokens[i].type == TokenType::END)
-            inputSymbol = "$";
-        else {
-            switch (tokens[i].type) {
-                case TokenType::IDENTIFIER: inputSymbol = "id"; break;
-                case TokenType::NUMBER: inputSymbol = "num"; break;
-                case TokenType::STRING: inputSymbol = "str"; break;
-                default: inputSymbol = tokens[i].lexeme; break;
-            }
-        }
-        
-        // If top of stack is a terminal or the end marker.
-        if (top == "$" || !isNonTerminal(top)) {
-            if (top == inputSymbol) {
-                stack.pop_back();
-                i++;
-            } else {
-                cerr << "Syntax Error: expected '" << top << "' but found '" << inputSymbol << "'" << endl;
-                return;
-            }
-        } else {
-            // Top is a nonterminal; look up the table.
-            pair<string, string> key = {top, inputSymbol};
-            if (parsingTable.find(key) == parsingTable.end()) {
-                cerr << "Syntax Error: no rule for (" << top << ", " << inputSymbol << ")" << endl;
-                return;
-            }
-            vector<int> prodIndices = parsingTable.at(key);
-            if (prodIndices.size() != 1) {
-                cerr << "Syntax Error: conflict in parsing table for (" << top << ", " << inputSymbol << ")" << endl;
-                return;
-            }
-            int prodIndex = prodIndices[0];
-            Production prod = grammar[prodIndex];
-            stack.pop_back();
-            if (!(prod.rhs.size() == 1 && prod.rhs[0] == EPSILON)) {
-                // Push right-hand side in reverse order.
-                for (int j = prod.rhs.size() - 1; j >= 0; j--) {
-                    stack.push_back(prod.rhs[j]);
-                }
-            }
-        }
-    }
-    
-    if (i != tokens.size()) {
-        cerr << "Syntax Error: input not fully consumed." << endl;
+// Grammar spelling of the input `tok`, for error messages.
+static string inputName(const Token *tok, const LL1Table &table) {
+    if (!tok)
+        return "$";
+    int16_t term = table.tokenTerminal[static_cast<size_t>(tok->type)];
+    if (term < 0)
+        return string(tok->lexeme);
+    return table.symbolNames[term];
+}
+
+string expectedError(const Token *tok, const LL1Table &table, uint16_t top) {
+    return string("Syntax Error: expected '") + table.symbolNames[top] + "' but found '" +
+           inputName(tok, table) + "'";
+}
+
+string noRuleError(const Token *tok, const LL1Table &table, uint16_t top, int16_t cell) {
+    return string(cell == LL1_CONFLICT ? "Syntax Error: conflict in parsing table for ("
+                                       : "Syntax Error: no rule for (") +
+           table.symbolNames[top] + ", " + inputName(tok, table) + ")";
+}
+
+string expectedError(const Token *tokens, size_t count, size_t i, const LL1Table &table, uint16_t top) {
+    return expectedError(i < count ? &tokens[i] : nullptr, table, top);
+}
+
+string noRuleError(const Token *tokens, size_t count, size_t i, const LL1Table &table,
+                   uint16_t top, int16_t cell) {
+    return noRuleError(i < count ? &tokens[i] : nullptr, table, top, cell);
+}
+
+bool ll1Check(const Token *tokens, size_t count, const LL1Table &table,
+              vector<uint16_t> &stack, string &error) {
+    return ll1Run(tokens, count, table, stack, error, [](const Token &) {});
+}
+
+bool ll1Check(const Token *tokens, size_t count, const LL1Table &table, string &error) {
+    vector<uint16_t> stack;
+    stack.reserve(64);
+    return ll1Check(tokens, count, table, stack, error);
+}
+
+void ll1Parse(const vector<Token>& tokens, const LL1Table &table) {
+    string error;
+    if (!ll1Check(tokens.data(), tokens.size(), table, error)) {
+        cerr << error << endl;
         return;
     }
     cout << "Parsing successful: Input is syntactically correct according to the LL(1) grammar." << endl;
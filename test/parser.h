@@ -3,14 +3,118 @@
 
 #include "grammar.h"
 #include "lexer.h"
+#include "ll1_table.h"
+#include "stats.h"
 #include "token.h"
+#include <cstdint>
 #include <vector>
-#include <map>
 #include <string>
 using namespace std;
 
+// Syntax error messages for the LL(1) parsers: `top` expected but the
+// input `tok` (null at the end of the input) does not match, or the table
+// has no single rule (`cell` is LL1_ERROR or LL1_CONFLICT) for `top` on it.
+string expectedError(const Token *tok, const LL1Table &table, uint16_t top);
+string noRuleError(const Token *tok, const LL1Table &table, uint16_t top, int16_t cell);
+// The same for the input at position i of tokens[0, count).
+string expectedError(const Token *tokens, size_t count, size_t i, const LL1Table &table, uint16_t top);
+string noRuleError(const Token *tokens, size_t count, size_t i, const LL1Table &table,
+                   uint16_t top, int16_t cell);
+
+// Token source over tokens[0, count), for ll1Run(). A source has
+// current(), the token under the cursor or null past the end of the input
+// (which reads as "$"), and advance().
+struct TokenArray {
+    const Token *tokens;
+    size_t count;
+    size_t i = 0;
+
+    TokenArray(const Token *tokens, size_t count) : tokens(tokens), count(count) {}
+    const Token *current() const { return i < count ? &tokens[i] : nullptr; }
+    void advance() { i++; }
+};
+
+// The LL(1) loop behind ll1Check(), pulling tokens from `source` one at a
+// time: it never looks further than the current token. Calls onMatch(tok)
+// for every token the parser matches, in input order, so a caller can
+// build what it needs while parsing instead of walking the tokens again
+// afterwards.
+template <class Source, class OnMatch>
+bool ll1Run(Source &source, const LL1Table &table,
+            vector<uint16_t> &stack, string &error, OnMatch &&onMatch) {
+    ParseCounters<vector<uint16_t>> counters(stack);
+    // Initialize a stack with end-marker "$" and the start symbol.
+    stack.clear();
+    stack.push_back(table.endTerminal);
+    stack.push_back(table.startSymbol);
+    counters.pushed(2);
+
+    // Current token as a terminal ID; -1 for tokens the grammar has no
+    // terminal for (lexical errors).
+    const Token *tok = source.current();
+    auto terminalOf = [&](const Token *t) -> int {
+        return t ? table.tokenTerminal[static_cast<size_t>(t->type)] : table.endTerminal;
+    };
+    int term = terminalOf(tok);
+
+    while (!stack.empty()) {
+        uint16_t top = stack.back();
+        if (table.isTerminal(top)) {
+            // Terminal or the end marker: it must match the input.
+            if (top != term) {
+                error = expectedError(tok, table, top);
+                counters.flush();
+                return false;
+            }
+            stack.pop_back();
+            if (tok)
+                onMatch(*tok);
+            source.advance();
+            tok = source.current();
+            term = terminalOf(tok);
+            continue;
+        }
+        // Top is a nonterminal; look up the table.
+        counters.lookup();
+        int16_t prod = term < 0 ? LL1_ERROR : table.cell(top, static_cast<uint16_t>(term));
+        if (prod < 0) {
+            error = noRuleError(tok, table, top, prod);
+            counters.flush();
+            return false;
+        }
+        // Replace the nonterminal with its precomputed, already reversed RHS.
+        stack.pop_back();
+        stack.insert(stack.end(), table.rhsSymbols + table.rhsBegin[prod],
+                     table.rhsSymbols + table.rhsBegin[prod + 1]);
+        counters.pushed(table.rhsBegin[prod + 1] - table.rhsBegin[prod]);
+    }
+
+    counters.flush();
+    if (tok) {
+        error = "Syntax Error: input not fully consumed.";
+        return false;
+    }
+    return true;
+}
+
+// ll1Run() over tokens[0, count).
+template <class OnMatch>
+bool ll1Run(const Token *tokens, size_t count, const LL1Table &table,
+            vector<uint16_t> &stack, string &error, OnMatch &&onMatch) {
+    TokenArray source(tokens, count);
+    return ll1Run(source, table, stack, error, onMatch);
+}
+
+// Runs the LL(1) parser over tokens[0, count); positions at or past `count`
+// read as the end marker, so a statement can be checked in place inside a
+// larger token array. Returns false with a message in `error` on a syntax
+// error. Prints nothing. Each step is an array lookup on integer IDs; the
+// only allocation is the growth of `stack`, which callers can reuse.
+bool ll1Check(const Token *tokens, size_t count, const LL1Table &table,
+              vector<uint16_t> &stack, string &error);
+bool ll1Check(const Token *tokens, size_t count, const LL1Table &table, string &error);
+
 // Prototype for LL(1) parser function that uses the parsing table.
-void ll1Parse(const vector<Token>& tokens, const vector<Production>& grammar,
-              const map<pair<string, string>, vector<int>> &parsingTable);
+void ll1Parse(const vector<Token>& tokens, const LL1Table &table);
 
 #endif // PARSER_H
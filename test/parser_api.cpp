@@ -0,0 +1,35 @@
+#include "parser_api.h"
+using namespace std;
+
+ParserContext::ParserContext() : view(builtinLL1Table) {}
+
+ParserContext::ParserContext(const vector<Production> &grammar) {
+    GrammarSets sets = computeGrammarSets(grammar);
+    auto first = firstSetsAsMap(sets);
+    auto follow = followSetsAsMap(sets);
+    auto parsingTable = constructParsingTable(grammar, first, follow);
+    data.reset(new LL1TableData(compileLL1Table(grammar, parsingTable)));
+    view = data->view();
+    if (!data->conflicts.empty()) {
+        failure = "grammar is not LL(1): " + data->conflicts.front();
+        if (data->conflicts.size() > 1)
+            failure += " (and " + to_string(data->conflicts.size() - 1) + " more conflicts)";
+    }
+}
+
+ParseSession::ParseSession(const ParserContext &context, ParseOptions options)
+    : context(context), options(options), cache(options.cacheEntries) {}
+
+const ParseResult &ParseSession::parse(string_view sql) {
+    Ast *out = nullptr;
+    if (options.buildAst) {
+        ast.clear();
+        out = &ast;
+    }
+    validateSerial(sql, context.table(), scratch, validation, out, options.cacheEntries ? &cache : nullptr);
+    result.statements = validation.statements;
+    // Swapped rather than copied, so both vectors keep their capacity.
+    result.errors.swap(validation.errors);
+    result.ast = out;
+    return result;
+}
@@ -0,0 +1,87 @@
+#ifndef PARSER_API_H
+#define PARSER_API_H
+
+#include "ast.h"
+#include "grammar.h"
+#include "ll1_table.h"
+#include "parallel.h"
+#include "parse_cache.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// Embedding interface (libsqlparser.a, see run.txt). A ParserContext holds
+// the grammar tables: it is built once, never changes afterwards, and can
+// be shared by any number of threads. A ParseSession is the per-thread
+// part: its stacks, token buffer, AST and parse cache are reused from one
+// parse() to the next, so a warmed-up session parses without allocating.
+// Nothing here reads files or writes to stdout/stderr.
+//
+//     ParserContext context;                  // Built-in tables.
+//     ParseSession session(context);          // One per thread.
+//     const ParseResult &r = session.parse(sql);
+//     if (!r.ok()) ... r.errors[i].offset, r.errors[i].message ...
+
+class ParserContext {
+public:
+    // The LL(1) tables built into the library for buildGrammar().
+    ParserContext();
+    // Tables compiled from `grammar`. If the grammar is not LL(1), ok() is
+    // false and error() names the conflicts; the context must not be used
+    // to parse.
+    explicit ParserContext(const vector<Production> &grammar);
+    ParserContext(const ParserContext &) = delete;
+    ParserContext &operator=(const ParserContext &) = delete;
+
+    bool ok() const { return failure.empty(); }
+    const string &error() const { return failure; }
+    const LL1Table &table() const { return view; }
+
+private:
+    unique_ptr<LL1TableData> data;   // Null for the built-in tables.
+    LL1Table view;
+    string failure;
+};
+
+struct ParseOptions {
+    bool buildAst = false;      // Build the AST of the valid statements.
+    size_t cacheEntries = 0;    // ParseCache size; 0 disables the cache.
+};
+
+// The outcome of one parse(). Owned by the session and valid until its
+// next parse().
+struct ParseResult {
+    size_t statements = 0;
+    vector<StatementError> errors;   // Sorted by offset into the input.
+    const Ast *ast = nullptr;        // Valid statements; null without buildAst.
+
+    bool ok() const { return errors.empty(); }
+};
+
+class ParseSession {
+public:
+    // The context must outlive the session.
+    explicit ParseSession(const ParserContext &context, ParseOptions options = ParseOptions());
+    ParseSession(const ParseSession &) = delete;
+    ParseSession &operator=(const ParseSession &) = delete;
+
+    // Parses `sql`, a sequence of `<statement> ";"` items. The input is not
+    // kept after the call.
+    const ParseResult &parse(string_view sql);
+
+    size_t cacheHits() const { return cache.hits(); }
+    size_t cacheMisses() const { return cache.misses(); }
+
+private:
+    const ParserContext &context;
+    ParseOptions options;
+    ValidationScratch scratch;
+    ParseCache cache;
+    Ast ast;
+    ValidationResult validation;
+    ParseResult result;
+};
+
+#endif // PARSER_API_H
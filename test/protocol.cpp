@@ -0,0 +1,61 @@
+#include "protocol.h"
+#include <cerrno>
+#include <unistd.h>
+using namespace std;
+
+// Reads exactly `n` bytes; false on EOF or error. `eofAtStart` tells the
+// two apart when nothing was read.
+static bool readAll(int fd, char *p, size_t n, bool &eofAtStart) {
+    size_t done = 0;
+    eofAtStart = false;
+    while (done < n) {
+        ssize_t r = ::read(fd, p + done, n - done);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0) {
+            eofAtStart = r == 0 && done == 0;
+            return false;
+        }
+        done += static_cast<size_t>(r);
+    }
+    return true;
+}
+
+bool readFrame(int fd, string &payload, string &error) {
+    unsigned char header[4];
+    bool eof;
+    if (!readAll(fd, reinterpret_cast<char *>(header), sizeof header, eof)) {
+        if (!eof)
+            error = "truncated frame header";
+        return false;
+    }
+    uint32_t n = header[0] | header[1] << 8 | header[2] << 16 | static_cast<uint32_t>(header[3]) << 24;
+    if (n > MAX_FRAME_SIZE) {
+        error = "frame of " + to_string(n) + " bytes exceeds the limit";
+        return false;
+    }
+    payload.resize(n);
+    if (n && !readAll(fd, &payload[0], n, eof)) {
+        error = "truncated frame";
+        return false;
+    }
+    return true;
+}
+
+bool writeFrame(int fd, string_view payload) {
+    string buf(4 + payload.size(), '\0');
+    uint32_t n = static_cast<uint32_t>(payload.size());
+    for (int i = 0; i < 4; i++)
+        buf[i] = static_cast<char>(n >> (8 * i));
+    buf.replace(4, payload.size(), payload.data(), payload.size());
+    size_t done = 0;
+    while (done < buf.size()) {
+        ssize_t w = ::write(fd, buf.data() + done, buf.size() - done);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return false;
+        done += static_cast<size_t>(w);
+    }
+    return true;
+}
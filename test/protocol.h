@@ -0,0 +1,34 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+using namespace std;
+
+// Framing for the compile server (sql_parser --serve) and its clients.
+// Every request and response is one frame: a 4-byte little-endian payload
+// length, then the payload. A request payload is SQL text; a response
+// payload is
+//
+//     OK <statements>
+// or
+//     ERROR <errors> <statements>
+//     Line <line> (offset <offset>): <message>
+//     ...
+//
+// with one line per syntax error, in source order.
+
+// Frames larger than this are rejected and the connection is closed.
+const uint32_t MAX_FRAME_SIZE = 64u << 20;
+
+// Reads one frame from `fd` into `payload`. Returns false at end of input,
+// on a read error or on an oversized frame; `error` is set in the last two
+// cases only.
+bool readFrame(int fd, string &payload, string &error);
+
+// Writes one frame. Returns false if the peer has gone away (callers
+// ignore SIGPIPE, so that is an EPIPE error rather than a signal).
+bool writeFrame(int fd, string_view payload);
+
+#endif // PROTOCOL_H
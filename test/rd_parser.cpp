@@ -0,0 +1,575 @@
+// Generated by tablegen from buildGrammar() in grammar.cpp. Do not edit;
+// rerun tablegen after changing the grammar (see run.txt).
+#include "rd_parser.h"
+#include "parser.h"
+
+namespace {
+
+class RDParser {
+public:
+    RDParser(const Token *tokens, size_t count, string &error)
+        : tokens(tokens), count(count), error(error) {}
+    bool parse();
+
+private:
+    const Token *tokens;
+    size_t count;
+    size_t i = 0;
+    string &error;
+
+    // Positions at or past `count` read as END, like "$" in ll1Run().
+    TokenType peek() const { return i < count ? tokens[i].type : TokenType::END; }
+    bool expected(uint16_t terminal) {
+        error = expectedError(tokens, count, i, builtinLL1Table, terminal);
+        return false;
+    }
+    bool noRule(uint16_t nonTerminal) {
+        error = noRuleError(tokens, count, i, builtinLL1Table, nonTerminal, LL1_ERROR);
+        return false;
+    }
+
+    bool parseSql();
+    bool parseSqlTail();
+    bool parseStatement();
+    bool parseCreateTableStmt();
+    bool parseColumnDefList();
+    bool parseColumnDefListTail();
+    bool parseColumnDef();
+    bool parseInsertStmt();
+    bool parseOptIdentifierList();
+    bool parseIdentifierList();
+    bool parseIdentifierListTail();
+    bool parseValueList();
+    bool parseValueListTail();
+    bool parseSelectStmt();
+    bool parseSelectList();
+    bool parseOptWhereClause();
+    bool parseWhereClause();
+    bool parseCondition();
+    bool parseConditionTail();
+    bool parseCompOperator();
+    bool parseIdentifier();
+    bool parseDatatype();
+    bool parseValue();
+    bool parseNumber();
+    bool parseString();
+};
+
+bool RDParser::parse() {
+    if (!parseSql())
+        return false;
+    TokenType type = peek();
+    if (type != TokenType::END)
+        return expected(25);
+    if (++i < count) {
+        error = "Syntax Error: input not fully consumed.";
+        return false;
+    }
+    return true;
+}
+
+// <sql>
+bool RDParser::parseSql() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::CREATE:
+    case TokenType::INSERT:
+    case TokenType::SELECT:
+        // <sql> ::= <statement> ; <sql_tail>
+        if (!parseStatement())
+            return false;
+        type = peek();
+        if (type != TokenType::SEMICOLON)
+            return expected(0);
+        i++;
+        return parseSqlTail();
+    default:
+        return noRule(26);
+    }
+}
+
+// <sql_tail>
+bool RDParser::parseSqlTail() {
+    for (;;) {
+        TokenType type = peek();
+        switch (type) {
+        case TokenType::CREATE:
+        case TokenType::INSERT:
+        case TokenType::SELECT:
+            // <sql_tail> ::= <statement> ; <sql_tail>
+            if (!parseStatement())
+                return false;
+            type = peek();
+            if (type != TokenType::SEMICOLON)
+                return expected(0);
+            i++;
+            continue;
+        case TokenType::END:
+            // <sql_tail> ::= EPSILON
+            return true;
+        default:
+            return noRule(27);
+        }
+    }
+}
+
+// <statement>
+bool RDParser::parseStatement() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::CREATE:
+        // <statement> ::= <create_table_stmt>
+        return parseCreateTableStmt();
+    case TokenType::INSERT:
+        // <statement> ::= <insert_stmt>
+        return parseInsertStmt();
+    case TokenType::SELECT:
+        // <statement> ::= <select_stmt>
+        return parseSelectStmt();
+    default:
+        return noRule(28);
+    }
+}
+
+// <create_table_stmt>
+bool RDParser::parseCreateTableStmt() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::CREATE:
+        // <create_table_stmt> ::= CREATE TABLE <identifier> ( <column_def_list> )
+        i++;
+        type = peek();
+        if (type != TokenType::TABLE)
+            return expected(2);
+        i++;
+        if (!parseIdentifier())
+            return false;
+        type = peek();
+        if (type != TokenType::LPAREN)
+            return expected(3);
+        i++;
+        if (!parseColumnDefList())
+            return false;
+        type = peek();
+        if (type != TokenType::RPAREN)
+            return expected(4);
+        i++;
+        return true;
+    default:
+        return noRule(29);
+    }
+}
+
+// <column_def_list>
+bool RDParser::parseColumnDefList() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::PRIMARY:
+    case TokenType::IDENTIFIER:
+        // <column_def_list> ::= <column_def> <column_def_list_tail>
+        if (!parseColumnDef())
+            return false;
+        return parseColumnDefListTail();
+    default:
+        return noRule(30);
+    }
+}
+
+// <column_def_list_tail>
+bool RDParser::parseColumnDefListTail() {
+    for (;;) {
+        TokenType type = peek();
+        switch (type) {
+        case TokenType::COMMA:
+            // <column_def_list_tail> ::= , <column_def> <column_def_list_tail>
+            i++;
+            if (!parseColumnDef())
+                return false;
+            continue;
+        case TokenType::RPAREN:
+            // <column_def_list_tail> ::= EPSILON
+            return true;
+        default:
+            return noRule(31);
+        }
+    }
+}
+
+// <column_def>
+bool RDParser::parseColumnDef() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::IDENTIFIER:
+        // <column_def> ::= <identifier> <datatype>
+        if (!parseIdentifier())
+            return false;
+        return parseDatatype();
+    case TokenType::PRIMARY:
+        // <column_def> ::= PRIMARY KEY ( <identifier> )
+        i++;
+        type = peek();
+        if (type != TokenType::KEY)
+            return expected(7);
+        i++;
+        type = peek();
+        if (type != TokenType::LPAREN)
+            return expected(3);
+        i++;
+        if (!parseIdentifier())
+            return false;
+        type = peek();
+        if (type != TokenType::RPAREN)
+            return expected(4);
+        i++;
+        return true;
+    default:
+        return noRule(32);
+    }
+}
+
+// <insert_stmt>
+bool RDParser::parseInsertStmt() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::INSERT:
+        // <insert_stmt> ::= INSERT INTO <identifier> <opt_identifier_list> VALUES ( <value_list> )
+        i++;
+        type = peek();
+        if (type != TokenType::INTO)
+            return expected(9);
+        i++;
+        if (!parseIdentifier())
+            return false;
+        if (!parseOptIdentifierList())
+            return false;
+        type = peek();
+        if (type != TokenType::VALUES)
+            return expected(10);
+        i++;
+        type = peek();
+        if (type != TokenType::LPAREN)
+            return expected(3);
+        i++;
+        if (!parseValueList())
+            return false;
+        type = peek();
+        if (type != TokenType::RPAREN)
+            return expected(4);
+        i++;
+        return true;
+    default:
+        return noRule(33);
+    }
+}
+
+// <opt_identifier_list>
+bool RDParser::parseOptIdentifierList() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::LPAREN:
+        // <opt_identifier_list> ::= ( <identifier_list> )
+        i++;
+        if (!parseIdentifierList())
+            return false;
+        type = peek();
+        if (type != TokenType::RPAREN)
+            return expected(4);
+        i++;
+        return true;
+    case TokenType::VALUES:
+        // <opt_identifier_list> ::= EPSILON
+        return true;
+    default:
+        return noRule(34);
+    }
+}
+
+// <identifier_list>
+bool RDParser::parseIdentifierList() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::IDENTIFIER:
+        // <identifier_list> ::= <identifier> <identifier_list_tail>
+        if (!parseIdentifier())
+            return false;
+        return parseIdentifierListTail();
+    default:
+        return noRule(35);
+    }
+}
+
+// <identifier_list_tail>
+bool RDParser::parseIdentifierListTail() {
+    for (;;) {
+        TokenType type = peek();
+        switch (type) {
+        case TokenType::COMMA:
+            // <identifier_list_tail> ::= , <identifier> <identifier_list_tail>
+            i++;
+            if (!parseIdentifier())
+                return false;
+            continue;
+        case TokenType::RPAREN:
+        case TokenType::FROM:
+            // <identifier_list_tail> ::= EPSILON
+            return true;
+        default:
+            return noRule(36);
+        }
+    }
+}
+
+// <value_list>
+bool RDParser::parseValueList() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::IDENTIFIER:
+    case TokenType::NUMBER:
+    case TokenType::STRING:
+        // <value_list> ::= <value> <value_list_tail>
+        if (!parseValue())
+            return false;
+        return parseValueListTail();
+    default:
+        return noRule(37);
+    }
+}
+
+// <value_list_tail>
+bool RDParser::parseValueListTail() {
+    for (;;) {
+        TokenType type = peek();
+        switch (type) {
+        case TokenType::COMMA:
+            // <value_list_tail> ::= , <value> <value_list_tail>
+            i++;
+            if (!parseValue())
+                return false;
+            continue;
+        case TokenType::RPAREN:
+            // <value_list_tail> ::= EPSILON
+            return true;
+        default:
+            return noRule(38);
+        }
+    }
+}
+
+// <select_stmt>
+bool RDParser::parseSelectStmt() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::SELECT:
+        // <select_stmt> ::= SELECT <select_list> FROM <identifier> <opt_where_clause>
+        i++;
+        if (!parseSelectList())
+            return false;
+        type = peek();
+        if (type != TokenType::FROM)
+            return expected(12);
+        i++;
+        if (!parseIdentifier())
+            return false;
+        return parseOptWhereClause();
+    default:
+        return noRule(39);
+    }
+}
+
+// <select_list>
+bool RDParser::parseSelectList() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::ASTERISK:
+        // <select_list> ::= *
+        i++;
+        return true;
+    case TokenType::IDENTIFIER:
+        // <select_list> ::= <identifier_list>
+        return parseIdentifierList();
+    default:
+        return noRule(40);
+    }
+}
+
+// <opt_where_clause>
+bool RDParser::parseOptWhereClause() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::WHERE:
+        // <opt_where_clause> ::= <where_clause>
+        return parseWhereClause();
+    case TokenType::SEMICOLON:
+        // <opt_where_clause> ::= EPSILON
+        return true;
+    default:
+        return noRule(41);
+    }
+}
+
+// <where_clause>
+bool RDParser::parseWhereClause() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::WHERE:
+        // <where_clause> ::= WHERE <condition>
+        i++;
+        return parseCondition();
+    default:
+        return noRule(42);
+    }
+}
+
+// <condition>
+bool RDParser::parseCondition() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::IDENTIFIER:
+        // <condition> ::= <identifier> <condition_tail>
+        if (!parseIdentifier())
+            return false;
+        return parseConditionTail();
+    default:
+        return noRule(43);
+    }
+}
+
+// <condition_tail>
+bool RDParser::parseConditionTail() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::EQUAL:
+    case TokenType::GREATER:
+    case TokenType::LESS:
+        // <condition_tail> ::= <comp_operator> <value>
+        if (!parseCompOperator())
+            return false;
+        return parseValue();
+    case TokenType::BETWEEN:
+        // <condition_tail> ::= BETWEEN <value> AND <value>
+        i++;
+        if (!parseValue())
+            return false;
+        type = peek();
+        if (type != TokenType::AND)
+            return expected(16);
+        i++;
+        return parseValue();
+    case TokenType::LIKE:
+        // <condition_tail> ::= LIKE <value>
+        i++;
+        return parseValue();
+    case TokenType::IN:
+        // <condition_tail> ::= IN ( <value_list> )
+        i++;
+        type = peek();
+        if (type != TokenType::LPAREN)
+            return expected(3);
+        i++;
+        if (!parseValueList())
+            return false;
+        type = peek();
+        if (type != TokenType::RPAREN)
+            return expected(4);
+        i++;
+        return true;
+    default:
+        return noRule(44);
+    }
+}
+
+// <comp_operator>
+bool RDParser::parseCompOperator() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::EQUAL:
+        // <comp_operator> ::= =
+        i++;
+        return true;
+    case TokenType::GREATER:
+        // <comp_operator> ::= >
+        i++;
+        return true;
+    case TokenType::LESS:
+        // <comp_operator> ::= <
+        i++;
+        return true;
+    default:
+        return noRule(45);
+    }
+}
+
+// <identifier>
+bool RDParser::parseIdentifier() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::IDENTIFIER:
+        // <identifier> ::= id
+        i++;
+        return true;
+    default:
+        return noRule(46);
+    }
+}
+
+// <datatype>
+bool RDParser::parseDatatype() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::IDENTIFIER:
+        // <datatype> ::= <identifier>
+        return parseIdentifier();
+    default:
+        return noRule(47);
+    }
+}
+
+// <value>
+bool RDParser::parseValue() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::NUMBER:
+        // <value> ::= <number>
+        return parseNumber();
+    case TokenType::STRING:
+        // <value> ::= <string>
+        return parseString();
+    case TokenType::IDENTIFIER:
+        // <value> ::= <identifier>
+        return parseIdentifier();
+    default:
+        return noRule(48);
+    }
+}
+
+// <number>
+bool RDParser::parseNumber() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::NUMBER:
+        // <number> ::= num
+        i++;
+        return true;
+    default:
+        return noRule(49);
+    }
+}
+
+// <string>
+bool RDParser::parseString() {
+    TokenType type = peek();
+    switch (type) {
+    case TokenType::STRING:
+        // <string> ::= str
+        i++;
+        return true;
+    default:
+        return noRule(50);
+    }
+}
+
+}  // namespace
+
+bool rdCheck(const Token *tokens, size_t count, string &error) {
+    return RDParser(tokens, count, error).parse();
+}
@@ -0,0 +1,15 @@
+#ifndef RD_PARSER_H
+#define RD_PARSER_H
+
+#include "token.h"
+#include <string>
+using namespace std;
+
+// Recursive-descent parser for buildGrammar(), generated by tablegen into
+// rd_parser.cpp from the same tables as builtinLL1Table: one function per
+// nonterminal, switching on the token type. Accepts and rejects what
+// ll1Check() with builtinLL1Table does, with the same messages, but
+// without a table lookup or a stack push per symbol.
+bool rdCheck(const Token *tokens, size_t count, string &error);
+
+#endif // RD_PARSER_H
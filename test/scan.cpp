@@ -0,0 +1,261 @@
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar fallback: one table lookup per byte.
+// ---------------------------------------------------------------------------
+
+static size_t scalarRun(const char *s, size_t pos, size_t n, uint8_t cls) {
+    while (pos < n && hasClass(s[pos], cls))
+        pos++;
+    return pos;
+}
+
+static size_t skipSpacesScalar(const char *s, size_t pos, size_t n) {
+    return scalarRun(s, pos, n, CC_SPACE);
+}
+
+static size_t scanIdentifierScalar(const char *s, size_t pos, size_t n) {
+    return scalarRun(s, pos, n, CC_IDENT);
+}
+
+static size_t scanDigitsScalar(const char *s, size_t pos, size_t n) {
+    return scalarRun(s, pos, n, CC_DIGIT);
+}
+
+static size_t findByteScalar(const char *s, size_t pos, size_t n, char c) {
+    while (pos < n && s[pos] != c)
+        pos++;
+    return pos;
+}
+
+static size_t findStatementBreakScalar(const char *s, size_t pos, size_t n) {
+    while (pos < n && s[pos] != ';' && s[pos] != '\'' && s[pos] != '"')
+        pos++;
+    return pos;
+}
+
+#ifdef SCAN_X86
+// ---------------------------------------------------------------------------
+// SSE2 (16 bytes per step) and AVX2 (32 bytes per step).
+// Each *Mask helper sets a byte to 0xFF when it belongs to the class. Bytes
+// >= 0x80 are negative under the signed compares and never match.
+// ---------------------------------------------------------------------------
+
+static inline __m128i inRange16(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(hi + 1)));
+}
+
+static inline __m128i spaceMask16(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), inRange16(v, '\t', '\r'));
+}
+
+static inline __m128i digitMask16(__m128i v) {
+    return inRange16(v, '0', '9');
+}
+
+static inline __m128i identMask16(__m128i v) {
+    // Setting bit 5 folds A-Z onto a-z without pulling in other ASCII symbols.
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    return _mm_or_si128(_mm_or_si128(inRange16(lower, 'a', 'z'), digitMask16(v)),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+}
+
+#define SSE2_RUN(name, maskFn, scalarFn)                                       \
+    static size_t name(const char *s, size_t pos, size_t n) {                  \
+        while (pos + 16 <= n) {                                                \
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + pos)); \
+            unsigned stop = ~static_cast<unsigned>(_mm_movemask_epi8(maskFn(v))) & 0xFFFFu; \
+            if (stop)                                                          \
+                return pos + __builtin_ctz(stop);                              \
+            pos += 16;                                                         \
+        }                                                                      \
+        return scalarFn(s, pos, n);                                            \
+    }
+
+SSE2_RUN(skipSpacesSSE2, spaceMask16, skipSpacesScalar)
+SSE2_RUN(scanIdentifierSSE2, identMask16, scanIdentifierScalar)
+SSE2_RUN(scanDigitsSSE2, digitMask16, scanDigitsScalar)
+#undef SSE2_RUN
+
+static size_t findByteSSE2(const char *s, size_t pos, size_t n, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    while (pos + 16 <= n) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + pos));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+        if (hit)
+            return pos + __builtin_ctz(hit);
+        pos += 16;
+    }
+    return findByteScalar(s, pos, n, c);
+}
+
+static inline __m128i breakMask16(__m128i v) {
+    return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(';')),
+                                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\''))),
+                        _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+}
+
+static size_t findStatementBreakSSE2(const char *s, size_t pos, size_t n) {
+    while (pos + 16 <= n) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + pos));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(breakMask16(v)));
+        if (hit)
+            return pos + __builtin_ctz(hit);
+        pos += 16;
+    }
+    return findStatementBreakScalar(s, pos, n);
+}
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i inRange32(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+
+AVX2 static inline __m256i spaceMask32(__m256i v) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), inRange32(v, '\t', '\r'));
+}
+
+AVX2 static inline __m256i digitMask32(__m256i v) {
+    return inRange32(v, '0', '9');
+}
+
+AVX2 static inline __m256i identMask32(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(_mm256_or_si256(inRange32(lower, 'a', 'z'), digitMask32(v)),
+                           _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+}
+
+// The 16-byte SSE2 routine finishes the tail.
+#define AVX2_RUN(name, maskFn, tailFn)                                         \
+    AVX2 static size_t name(const char *s, size_t pos, size_t n) {             \
+        while (pos + 32 <= n) {                                                \
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + pos)); \
+            unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(maskFn(v))); \
+            if (stop)                                                          \
+                return pos + __builtin_ctz(stop);                              \
+            pos += 32;                                                         \
+        }                                                                      \
+        return tailFn(s, pos, n);                                              \
+    }
+
+AVX2_RUN(skipSpacesAVX2, spaceMask32, skipSpacesSSE2)
+AVX2_RUN(scanIdentifierAVX2, identMask32, scanIdentifierSSE2)
+AVX2_RUN(scanDigitsAVX2, digitMask32, scanDigitsSSE2)
+#undef AVX2_RUN
+
+AVX2 static size_t findByteAVX2(const char *s, size_t pos, size_t n, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    while (pos + 32 <= n) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + pos));
+        unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        if (hit)
+            return pos + __builtin_ctz(hit);
+        pos += 32;
+    }
+    return findByteSSE2(s, pos, n, c);
+}
+AVX2 static size_t findStatementBreakAVX2(const char *s, size_t pos, size_t n) {
+    while (pos + 32 <= n) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + pos));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(';')),
+                                                       _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\''))),
+                                       _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+        unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+        if (hit)
+            return pos + __builtin_ctz(hit);
+        pos += 32;
+    }
+    return findStatementBreakSSE2(s, pos, n);
+}
+#undef AVX2
+#endif // SCAN_X86
+
+// ---------------------------------------------------------------------------
+// Runtime dispatch.
+// ---------------------------------------------------------------------------
+
+struct ScanOps {
+    ScanMode mode;
+    size_t (*skipSpaces)(const char *, size_t, size_t);
+    size_t (*scanIdentifier)(const char *, size_t, size_t);
+    size_t (*scanDigits)(const char *, size_t, size_t);
+    size_t (*findByte)(const char *, size_t, size_t, char);
+    size_t (*findStatementBreak)(const char *, size_t, size_t);
+};
+
+static const ScanOps scalarOps = {ScanMode::Scalar, skipSpacesScalar, scanIdentifierScalar,
+                                  scanDigitsScalar, findByteScalar, findStatementBreakScalar};
+#ifdef SCAN_X86
+static const ScanOps sse2Ops = {ScanMode::SSE2, skipSpacesSSE2, scanIdentifierSSE2,
+                                scanDigitsSSE2, findByteSSE2, findStatementBreakSSE2};
+static const ScanOps avx2Ops = {ScanMode::AVX2, skipSpacesAVX2, scanIdentifierAVX2,
+                                scanDigitsAVX2, findByteAVX2, findStatementBreakAVX2};
+#endif
+
+static const ScanOps *opsFor(ScanMode mode) {
+    switch (mode) {
+        case ScanMode::Scalar: return &scalarOps;
+#ifdef SCAN_X86
+        case ScanMode::SSE2:   return __builtin_cpu_supports("sse2") ? &sse2Ops : nullptr;
+        case ScanMode::AVX2:   return __builtin_cpu_supports("avx2") ? &avx2Ops : nullptr;
+#endif
+        default:               return nullptr;
+    }
+}
+
+ScanMode bestScanMode() {
+    if (opsFor(ScanMode::AVX2)) return ScanMode::AVX2;
+    if (opsFor(ScanMode::SSE2)) return ScanMode::SSE2;
+    return ScanMode::Scalar;
+}
+
+static const ScanOps *activeOps = opsFor(bestScanMode());
+
+bool setScanMode(ScanMode mode) {
+    const ScanOps *ops = opsFor(mode);
+    if (!ops)
+        return false;
+    activeOps = ops;
+    return true;
+}
+
+ScanMode activeScanMode() {
+    return activeOps->mode;
+}
+
+const char *scanModeName(ScanMode mode) {
+    switch (mode) {
+        case ScanMode::Scalar: return "scalar";
+        case ScanMode::SSE2:   return "sse2";
+        case ScanMode::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+size_t skipSpaces(const char *s, size_t pos, size_t n) {
+    return activeOps->skipSpaces(s, pos, n);
+}
+
+size_t scanIdentifier(const char *s, size_t pos, size_t n) {
+    return activeOps->scanIdentifier(s, pos, n);
+}
+
+size_t scanDigits(const char *s, size_t pos, size_t n) {
+    return activeOps->scanDigits(s, pos, n);
+}
+
+size_t findByte(const char *s, size_t pos, size_t n, char c) {
+    return activeOps->findByte(s, pos, n, c);
+}
+
+size_t findStatementBreak(const char *s, size_t pos, size_t n) {
+    return activeOps->findStatementBreak(s, pos, n);
+}
@@ -0,0 +1,59 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+using namespace std;
+
+// Character classes used by the lexer. The table only classifies ASCII, so
+// unlike <cctype> it never consults the locale.
+enum CharClass : uint8_t {
+    CC_SPACE = 1,   // ' ', \t, \n, \v, \f, \r
+    CC_ALPHA = 2,   // A-Z, a-z, _
+    CC_DIGIT = 4,   // 0-9
+    CC_IDENT = CC_ALPHA | CC_DIGIT
+};
+
+constexpr uint8_t classOf(unsigned c) {
+    if (c == ' ' || (c >= '\t' && c <= '\r'))
+        return CC_SPACE;
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_')
+        return CC_ALPHA;
+    if (c >= '0' && c <= '9')
+        return CC_DIGIT;
+    return 0;
+}
+
+struct CharClassTable {
+    uint8_t v[256];
+    constexpr CharClassTable() : v() {
+        for (unsigned c = 0; c < 256; c++)
+            v[c] = classOf(c);
+    }
+};
+
+inline constexpr CharClassTable charClasses{};
+
+inline bool hasClass(char c, uint8_t cls) {
+    return (charClasses.v[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+// Implementations of the run scanners below.
+enum class ScanMode { Scalar, SSE2, AVX2 };
+
+// Each scanner starts at s[pos] and returns the offset of the first byte in
+// [pos, n) that ends the run (or n when the run reaches the end).
+size_t skipSpaces(const char *s, size_t pos, size_t n);      // whitespace
+size_t scanIdentifier(const char *s, size_t pos, size_t n);  // [A-Za-z0-9_]
+size_t scanDigits(const char *s, size_t pos, size_t n);      // [0-9]
+size_t findByte(const char *s, size_t pos, size_t n, char c); // first s[i] == c
+size_t findStatementBreak(const char *s, size_t pos, size_t n); // first ; ' or "
+
+// The best mode the CPU supports is selected at startup. Forcing a mode
+// the CPU lacks returns false and leaves the current mode in place.
+bool setScanMode(ScanMode mode);
+ScanMode activeScanMode();
+ScanMode bestScanMode();
+const char *scanModeName(ScanMode mode);
+
+#endif // SCAN_H
@@ -0,0 +1,211 @@
+#include "semantic.h"
+#include <algorithm>
+#include "stats.h"
+using namespace std;
+
+static string quoted(uint32_t symbol) {
+    return "'" + string(symbolText(symbol)) + "'";
+}
+
+bool SemanticAnalyzer::firstSighting(uint32_t column) {
+    if (column >= seen.size())
+        seen.resize(catalog.columnCount(), 0);
+    if (seen[column] == stamp)
+        return false;
+    seen[column] = stamp;
+    return true;
+}
+
+uint32_t SemanticAnalyzer::lookupTable(uint32_t name, string &error) const {
+    uint32_t table = catalog.findTable(name);
+    if (table == NO_ID)
+        error = "Semantic Error: unknown table " + quoted(name) + ".";
+    return table;
+}
+
+uint32_t SemanticAnalyzer::lookupColumn(uint32_t table, uint32_t name, string &error) const {
+    uint32_t column = catalog.findColumn(table, name);
+    if (column == NO_ID)
+        error = "Semantic Error: unknown column " + quoted(name) + " in table " +
+                quoted(catalog.tables.name[table]) + ".";
+    return column;
+}
+
+// Whether value `value` of a statement on `table` fits `column`: stored
+// in it by INSERT (`store`), or compared with it by WHERE.
+bool SemanticAnalyzer::checkValue(const Ast &ast, uint32_t value, uint32_t table, uint32_t column,
+                                  bool store, Resolution &resolution, string &error) {
+    ValueKind kind = ast.values.kind[value];
+    ColumnType type = catalog.columns.type[column];
+    uint32_t columnName = catalog.columns.name[column];
+    if (kind == ValueKind::Identifier) {
+        uint32_t name = ast.values.symbol[value];
+        if (store) {
+            error = "Semantic Error: " + quoted(name) + " is a name, not a value.";
+            return false;
+        }
+        uint32_t other = lookupColumn(table, name, error);
+        if (other == NO_ID)
+            return false;
+        ColumnType otherType = catalog.columns.type[other];
+        if ((otherType == ColumnType::Text) != (type == ColumnType::Text)) {
+            error = "Semantic Error: cannot compare " + quoted(columnName) + " (" + columnTypeName(type) +
+                    ") with " + quoted(name) + " (" + columnTypeName(otherType) + ").";
+            return false;
+        }
+        resolution.valueColumn[value] = other;
+        return true;
+    }
+    string_view text = ast.str(ast.values.text[value]);
+    bool fits = type == ColumnType::Text ? kind == ValueKind::String
+              : kind == ValueKind::Number && (type == ColumnType::Decimal || !store ||
+                                              text.find('.') == string_view::npos);
+    if (!fits) {
+        string what = kind == ValueKind::String ? "a string" : "number " + string(text);
+        error = "Semantic Error: " + what + (store ? " does not fit column " : " cannot be compared with column ") +
+                quoted(columnName) + " (" + columnTypeName(type) + ").";
+    }
+    return fits;
+}
+
+uint32_t SemanticAnalyzer::checkCreate(const Ast &ast, uint32_t row, string &error) {
+    const Ast::CreateTables &c = ast.createTables;
+    uint32_t name = c.table[row];
+    if (catalog.findTable(name) != NO_ID) {
+        error = "Semantic Error: table " + quoted(name) + " already exists.";
+        return NO_ID;
+    }
+    if (c.repeatedKey[row] != NO_SYMBOL) {
+        error = "Semantic Error: more than one PRIMARY KEY for " + quoted(name) + ".";
+        return NO_ID;
+    }
+    uint32_t key = c.primaryKey[row];
+    bool keyFound = key == NO_SYMBOL;
+    pending.clear();
+    pendingNames.clear();
+    for (uint32_t d = c.firstColumn[row]; d < c.firstColumn[row] + c.columnCount[row]; d++) {
+        uint32_t column = ast.columnDefs.name[d];
+        ColumnType type;
+        if (!columnTypeFromName(symbolText(ast.columnDefs.type[d]), type)) {
+            error = "Semantic Error: unknown type " + quoted(ast.columnDefs.type[d]) + " for column " +
+                    quoted(column) + ".";
+            return NO_ID;
+        }
+        if (!pendingNames.insert(column, d)) {
+            error = "Semantic Error: column " + quoted(column) + " declared twice.";
+            return NO_ID;
+        }
+        keyFound |= column == key;
+        pending.push_back({column, type});
+    }
+    if (!keyFound) {
+        error = "Semantic Error: primary key " + quoted(key) + " is not a column of " + quoted(name) + ".";
+        return NO_ID;
+    }
+    uint32_t table = catalog.addTable(name);
+    for (const auto &p : pending) {
+        uint32_t column = catalog.addColumn(p.first, p.second);
+        if (p.first == key)
+            catalog.setPrimaryKey(column);
+    }
+    return table;
+}
+
+uint32_t SemanticAnalyzer::checkInsert(const Ast &ast, uint32_t row, Resolution &resolution, string &error) {
+    const Ast::Inserts &ins = ast.inserts;
+    uint32_t table = lookupTable(ins.table[row], error);
+    if (table == NO_ID)
+        return NO_ID;
+    uint32_t first = ins.firstColumn[row];
+    uint32_t columns = ins.columnCount[row];
+    uint32_t key = catalog.tables.primaryKey[table];
+    if (columns) {
+        bool keyGiven = key == NO_ID;
+        for (uint32_t n = first; n < first + columns; n++) {
+            uint32_t column = lookupColumn(table, ast.names[n], error);
+            if (column == NO_ID)
+                return NO_ID;
+            if (!firstSighting(column)) {
+                error = "Semantic Error: column " + quoted(ast.names[n]) + " listed twice.";
+                return NO_ID;
+            }
+            keyGiven |= column == key;
+            resolution.names[n] = column;
+        }
+        if (!keyGiven) {
+            error = "Semantic Error: no value for primary key " + quoted(catalog.columns.name[key]) + ".";
+            return NO_ID;
+        }
+    } else {
+        columns = catalog.tables.columnCount[table];
+    }
+    if (ins.valueCount[row] != columns) {
+        error = "Semantic Error: " + to_string(ins.valueCount[row]) + " values for " + to_string(columns) +
+                " columns of " + quoted(ins.table[row]) + ".";
+        return NO_ID;
+    }
+    for (uint32_t v = 0; v < columns; v++) {
+        uint32_t column = ins.columnCount[row] ? resolution.names[first + v] : catalog.tables.firstColumn[table] + v;
+        if (!checkValue(ast, ins.firstValue[row] + v, table, column, true, resolution, error))
+            return NO_ID;
+    }
+    return table;
+}
+
+uint32_t SemanticAnalyzer::checkSelect(const Ast &ast, uint32_t row, Resolution &resolution, string &error) {
+    const Ast::Selects &sel = ast.selects;
+    uint32_t table = lookupTable(sel.table[row], error);
+    if (table == NO_ID)
+        return NO_ID;
+    for (uint32_t n = sel.firstColumn[row]; n < sel.firstColumn[row] + sel.columnCount[row]; n++) {
+        resolution.names[n] = lookupColumn(table, ast.names[n], error);
+        if (resolution.names[n] == NO_ID)
+            return NO_ID;
+    }
+    if (sel.condition[row] == ConditionKind::None)
+        return table;
+    uint32_t column = lookupColumn(table, sel.conditionColumn[row], error);
+    if (column == NO_ID)
+        return NO_ID;
+    resolution.conditionColumn[row] = column;
+    if (sel.condition[row] == ConditionKind::Like && catalog.columns.type[column] != ColumnType::Text) {
+        error = "Semantic Error: LIKE needs a VARCHAR column, " + quoted(sel.conditionColumn[row]) + " is " +
+                columnTypeName(catalog.columns.type[column]) + ".";
+        return NO_ID;
+    }
+    for (uint32_t v = sel.firstValue[row]; v < sel.firstValue[row] + sel.valueCount[row]; v++) {
+        if (!checkValue(ast, v, table, column, false, resolution, error))
+            return NO_ID;
+    }
+    return table;
+}
+
+size_t SemanticAnalyzer::analyze(const Ast &ast, Resolution &resolution, vector<StatementError> &errors) {
+    STATS_PHASE(Phase::Analyze);
+    resolution.table.assign(ast.size(), NO_ID);
+    resolution.names.assign(ast.names.size(), NO_ID);
+    resolution.conditionColumn.assign(ast.selects.table.size(), NO_ID);
+    resolution.valueColumn.assign(ast.values.kind.size(), NO_ID);
+    size_t failed = 0;
+    string error;
+    for (size_t s = 0; s < ast.size(); s++) {
+        if (++stamp == 0) {     // Wrapped: forget all sightings.
+            fill(seen.begin(), seen.end(), 0);
+            stamp = 1;
+        }
+        uint32_t row = ast.statements.row[s];
+        uint32_t table;
+        switch (ast.statements.kind[s]) {
+            case StatementKind::CreateTable: table = checkCreate(ast, row, error); break;
+            case StatementKind::Insert: table = checkInsert(ast, row, resolution, error); break;
+            default: table = checkSelect(ast, row, resolution, error); break;
+        }
+        resolution.table[s] = table;
+        if (table == NO_ID) {
+            errors.push_back({ast.statements.offset[s], move(error)});
+            error.clear();
+            failed++;
+        }
+    }
+    return failed;
+}
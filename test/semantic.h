@@ -0,0 +1,68 @@
+#ifndef SEMANTIC_H
+#define SEMANTIC_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ast.h"
+#include "catalog.h"
+#include "parallel.h"
+using namespace std;
+
+// Semantic checks of parsed statements against a Catalog:
+//   CREATE TABLE  the table is new, its column names are distinct, its
+//                 types are known and the primary key is one of its columns;
+//   INSERT        the table and the listed columns exist, no column is
+//                 listed twice, the primary key gets a value, there are as
+//                 many values as columns and each value fits its column
+//                 (an integer for INT, a number for DECIMAL, a string for
+//                 VARCHAR);
+//   SELECT        the table and the selected and WHERE columns exist, the
+//                 WHERE values compare with the column (a number with INT
+//                 and DECIMAL, a string with VARCHAR, or a column of the
+//                 same table and kind) and LIKE is on a VARCHAR column.
+// Names are symbols, so each costs one lookup of an integer key and a
+// statement is checked in time linear in its size. Only the first error
+// of a statement is reported.
+
+// The catalog IDs the pass resolved for one Ast, parallel to its tables,
+// so later stages need not look names up again. Only the entries of
+// statements whose table is not NO_ID are meaningful.
+struct Resolution {
+    vector<uint32_t> table;             // [statement] table ID.
+    vector<uint32_t> names;             // [Ast::names] column ID.
+    vector<uint32_t> conditionColumn;   // [select row] column ID; NO_ID without WHERE.
+    vector<uint32_t> valueColumn;       // [Ast::values] column ID of an identifier value.
+};
+
+class SemanticAnalyzer {
+public:
+    explicit SemanticAnalyzer(Catalog &catalog) : catalog(catalog) {}
+
+    // Checks the statements of `ast` in order. Each valid CREATE TABLE adds
+    // its table to the catalog, so later statements, and later calls, see
+    // it. Appends one error per failing statement to `errors`, at the
+    // statement's offset, and returns how many statements failed.
+    size_t analyze(const Ast &ast, Resolution &resolution, vector<StatementError> &errors);
+
+private:
+    // Each returns the statement's table ID, or NO_ID with `error` set.
+    uint32_t checkCreate(const Ast &ast, uint32_t row, string &error);
+    uint32_t checkInsert(const Ast &ast, uint32_t row, Resolution &resolution, string &error);
+    uint32_t checkSelect(const Ast &ast, uint32_t row, Resolution &resolution, string &error);
+    bool checkValue(const Ast &ast, uint32_t value, uint32_t table, uint32_t column, bool store,
+                    Resolution &resolution, string &error);
+    uint32_t lookupTable(uint32_t name, string &error) const;
+    uint32_t lookupColumn(uint32_t table, uint32_t name, string &error) const;
+    // Marks a column as named by the current statement; false if it was.
+    bool firstSighting(uint32_t column);
+
+    Catalog &catalog;
+    vector<uint32_t> seen;      // [column ID] stamp of the statement that last named it.
+    uint32_t stamp = 0;
+    vector<pair<uint32_t, ColumnType>> pending;     // Columns of the CREATE TABLE being checked.
+    IdMap pendingNames;                             // Their names.
+};
+
+#endif // SEMANTIC_H
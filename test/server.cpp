@@ -0,0 +1,235 @@
+#include "server.h"
+#include "parallel.h"
+#include "parse_cache.h"
+#include "protocol.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <poll.h>
+#include <set>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+using namespace std;
+
+// Most requests a stream batch takes in at once.
+static const size_t MAX_BATCH = 256;
+
+string handleRequest(string_view sql, const LL1Table &table, ValidationScratch &scratch, ParseCache *cache) {
+    ValidationResult result = validateSerial(sql, table, scratch, nullptr, cache);
+    if (result.errors.empty())
+        return "OK " + to_string(result.statements) + "\n";
+    string out = "ERROR " + to_string(result.errors.size()) + " " + to_string(result.statements) + "\n";
+    // Errors are sorted, so line numbers can be counted in one pass.
+    size_t line = 1;
+    size_t counted = 0;
+    for (const auto &e : result.errors) {
+        line += count(sql.begin() + counted, sql.begin() + e.offset, '\n');
+        counted = e.offset;
+        out += "Line " + to_string(line) + " (offset " + to_string(e.offset) + "): " + e.message + "\n";
+    }
+    return out;
+}
+
+// True if `fd` can be read without blocking.
+static bool readable(int fd) {
+    pollfd p = {fd, POLLIN, 0};
+    return poll(&p, 1, 0) > 0 && (p.revents & POLLIN);
+}
+
+int serveStream(int in, int out, const LL1Table &table, unsigned jobs, size_t cacheEntries) {
+    signal(SIGPIPE, SIG_IGN);
+    ThreadPool pool(jobs);
+    vector<ValidationScratch> scratch(pool.size());
+    vector<ParseCache> caches;
+    if (cacheEntries)
+        caches.assign(pool.size(), ParseCache(cacheEntries));
+    vector<string> requests(MAX_BATCH), responses(MAX_BATCH);
+    string error;
+    for (;;) {
+        // Block for one request, then take whatever else is already there.
+        size_t n = 0;
+        while (n < MAX_BATCH && (n == 0 || readable(in)) && readFrame(in, requests[n], error))
+            n++;
+        if (n == 0 && error.empty())
+            return 0;   // End of input.
+        pool.parallelFor(n, [&](size_t r, unsigned worker) {
+            responses[r] = handleRequest(requests[r], table, scratch[worker],
+                                         cacheEntries ? &caches[worker] : nullptr);
+        });
+        for (size_t r = 0; r < n; r++) {
+            if (!writeFrame(out, responses[r]))
+                return 0;   // The client has gone away.
+        }
+        if (!error.empty()) {
+            cerr << "Error: " << error << endl;
+            return 1;
+        }
+    }
+}
+
+// Requests handed from connection threads to the parse workers. Each job
+// is answered through its promise, so a connection gets its responses in
+// request order.
+struct Job {
+    string_view sql;
+    promise<string> response;
+};
+
+class JobQueue {
+public:
+    void push(Job *job) {
+        {
+            lock_guard<mutex> hold(lock);
+            jobs.push_back(job);
+        }
+        ready.notify_one();
+    }
+    // The next job; nullptr once the queue is closed and empty.
+    Job *pop() {
+        unique_lock<mutex> hold(lock);
+        ready.wait(hold, [&] { return !jobs.empty() || closed; });
+        if (jobs.empty())
+            return nullptr;
+        Job *job = jobs.front();
+        jobs.pop_front();
+        return job;
+    }
+    // Lets the workers finish the jobs left and return.
+    void close() {
+        {
+            lock_guard<mutex> hold(lock);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    mutex lock;
+    condition_variable ready;
+    deque<Job *> jobs;
+    bool closed = false;
+};
+
+// The open connections. Their threads are detached, so the server ends
+// them through their sockets and waits here until none uses its state.
+class ConnectionSet {
+public:
+    void add(int fd) {
+        lock_guard<mutex> hold(lock);
+        fds.insert(fd);
+    }
+    // The connection's thread calls this after its last use of the queue.
+    void remove(int fd) {
+        lock_guard<mutex> hold(lock);
+        fds.erase(fd);
+        if (fds.empty())
+            idle.notify_all();
+    }
+    // Shuts every connection down and waits until all have been removed.
+    void closeAll() {
+        unique_lock<mutex> hold(lock);
+        for (int fd : fds)
+            shutdown(fd, SHUT_RDWR);
+        idle.wait(hold, [&] { return fds.empty(); });
+    }
+
+private:
+    mutex lock;
+    condition_variable idle;
+    set<int> fds;
+};
+
+// Reads the requests of one client, has them handled by the workers and
+// writes the responses, until the client disconnects.
+static void serveConnection(int fd, JobQueue &queue, ConnectionSet &connections) {
+    string request, error;
+    while (readFrame(fd, request, error)) {
+        Job job;
+        job.sql = request;
+        future<string> response = job.response.get_future();
+        queue.push(&job);
+        if (!writeFrame(fd, response.get()))
+            break;
+    }
+    if (!error.empty())
+        cerr << "Error: " << error << "; closing the connection" << endl;
+    // Removed before closing, so closeAll() cannot shut down a reused fd.
+    connections.remove(fd);
+    close(fd);
+}
+
+int serveSocket(const string &path, const LL1Table &table, unsigned jobs, size_t cacheEntries) {
+    signal(SIGPIPE, SIG_IGN);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) {
+        cerr << "Error: socket path too long: " << path << endl;
+        return 1;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        cerr << "Error: Unable to create a socket: " << strerror(errno) << endl;
+        return 1;
+    }
+    // Replace a stale socket, but never another kind of file.
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            cerr << "Error: Unable to listen on " << path << ": " << strerror(EADDRINUSE) << endl;
+            close(listener);
+            return 1;
+        }
+        unlink(path.c_str());
+    }
+    if (bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof addr) != 0 || listen(listener, 128) != 0) {
+        cerr << "Error: Unable to listen on " << path << ": " << strerror(errno) << endl;
+        close(listener);
+        return 1;
+    }
+    if (jobs == 0)
+        jobs = max(1u, thread::hardware_concurrency());
+    cerr << "Listening on " << path << " with " << jobs << " workers" << endl;
+
+    // Parse workers, each with its own scratch state and cache.
+    JobQueue queue;
+    vector<thread> workers;
+    for (unsigned w = 0; w < jobs; w++) {
+        workers.emplace_back([&table, &queue, cacheEntries]() {
+            ValidationScratch scratch;
+            ParseCache cache(cacheEntries);
+            while (Job *job = queue.pop())
+                job->response.set_value(handleRequest(job->sql, table, scratch, cacheEntries ? &cache : nullptr));
+        });
+    }
+    // One thread per connection, for its I/O only.
+    ConnectionSet connections;
+    for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            cerr << "Error: accept failed: " << strerror(errno) << endl;
+            break;
+        }
+        connections.add(fd);
+        thread(serveConnection, fd, ref(queue), ref(connections)).detach();
+    }
+    // No thread may outlive the queue, the connection set or the table.
+    close(listener);
+    connections.closeAll();
+    queue.close();
+    for (auto &w : workers)
+        w.join();
+    return 1;
+}
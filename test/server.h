@@ -0,0 +1,33 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "ll1_table.h"
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+class ParseCache;
+struct ValidationScratch;
+
+// Compile server: the tables are set up once, then SQL requests framed as
+// in protocol.h are validated and answered until the input ends. All
+// workers share the read-only LL1Table; each has its own scratch state and,
+// with cacheEntries > 0, its own ParseCache. Nothing is written to disk.
+
+// Validates one request and formats the response payload.
+string handleRequest(string_view sql, const LL1Table &table, ValidationScratch &scratch, ParseCache *cache);
+
+// Serves the requests on `in` and writes the responses to `out`, in request
+// order. Requests already waiting when the server reads are handled as one
+// batch on `jobs` threads. Returns nonzero on a framing error.
+int serveStream(int in, int out, const LL1Table &table, unsigned jobs, size_t cacheEntries);
+
+// Listens on the Unix domain socket `path`, replacing a stale socket there
+// but refusing any other kind of file. Each connection gets a thread for
+// its I/O; the requests are validated by `jobs` worker threads. Runs until
+// the process is killed; returns nonzero if the socket cannot be set up,
+// or if accepting fails, once all its threads have finished.
+int serveSocket(const string &path, const LL1Table &table, unsigned jobs, size_t cacheEntries);
+
+#endif // SERVER_H
@@ -0,0 +1,140 @@
+#include "stats.h"
+#include <iomanip>
+#include <mutex>
+using namespace std;
+
+const char *phaseName(Phase p) {
+    switch (p) {
+        case Phase::Lex: return "lex";
+        case Phase::GrammarSets: return "grammar_sets";
+        case Phase::TableBuild: return "table_build";
+        case Phase::Parse: return "parse";
+        case Phase::Validate: return "validate";
+        case Phase::Analyze: return "analyze";
+        case Phase::Execute: return "execute";
+        case Phase::WriteSymbolTable: return "write_symtab";
+        case Phase::WriteParseTree: return "write_parse_tree";
+        case Phase::WriteParsingTable: return "write_parsing_table";
+        case Phase::WriteGrammar: return "write_grammar";
+        default: return "?";
+    }
+}
+
+const char *counterName(Counter c) {
+    switch (c) {
+        case Counter::Tokens: return "tokens";
+        case Counter::TableLookups: return "table_lookups";
+        case Counter::StackPushes: return "stack_pushes";
+        case Counter::StackPops: return "stack_pops";
+        case Counter::MaxStackDepth: return "max_stack_depth";
+        case Counter::Allocations: return "allocations";
+        case Counter::AllocatedBytes: return "allocated_bytes";
+        default: return "?";
+    }
+}
+
+#ifndef SQL_NO_STATS
+
+// Live threads' blocks, and the totals of the threads that have exited.
+// The registry is an intrusive list so that registering does not allocate:
+// operator new itself counts through here.
+static mutex registryLock;
+static ThreadStats *registryHead = nullptr;
+static StatsSnapshot retired;
+
+thread_local ThreadStats *currentThreadStats = nullptr;
+// Takes the counts of a thread whose block is gone (from destructors of
+// other thread_locals); they are dropped.
+static thread_local ThreadStats lateStats;
+
+static void addInto(StatsSnapshot &to, const ThreadStats &from) {
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        to.phaseCalls[p] += from.phaseCalls[p].load(memory_order_relaxed);
+        to.phaseNanos[p] += from.phaseNanos[p].load(memory_order_relaxed);
+    }
+    for (size_t c = 0; c < COUNTER_COUNT; c++) {
+        uint64_t v = from.counters[c].load(memory_order_relaxed);
+        if (c == static_cast<size_t>(Counter::MaxStackDepth))
+            to.counters[c] = max(to.counters[c], v);
+        else
+            to.counters[c] += v;
+    }
+}
+
+namespace {
+struct ThreadSlot {
+    ThreadStats stats = {};
+
+    ThreadSlot() {
+        currentThreadStats = &stats;
+        lock_guard<mutex> hold(registryLock);
+        stats.next = registryHead;
+        registryHead = &stats;
+    }
+    ~ThreadSlot() {
+        lock_guard<mutex> hold(registryLock);
+        addInto(retired, stats);
+        for (ThreadStats **p = &registryHead; *p; p = &(*p)->next) {
+            if (*p == &stats) {
+                *p = stats.next;
+                break;
+            }
+        }
+        currentThreadStats = &lateStats;
+    }
+};
+}
+
+ThreadStats *registerThreadStats() {
+    static thread_local ThreadSlot slot;
+    return &slot.stats;
+}
+
+StatsSnapshot collectStats() {
+    lock_guard<mutex> hold(registryLock);
+    StatsSnapshot total = retired;
+    for (const ThreadStats *s = registryHead; s; s = s->next)
+        addInto(total, *s);
+    return total;
+}
+
+#else
+
+StatsSnapshot collectStats() {
+    return StatsSnapshot();
+}
+
+#endif // SQL_NO_STATS
+
+void printStats(ostream &out, const StatsSnapshot &stats, double wallSeconds) {
+    out << "=== Statistics ===" << endl;
+    out << left << setw(22) << "phase" << right << setw(8) << "calls" << setw(14) << "ms" << endl;
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        if (!stats.phaseCalls[p])
+            continue;
+        out << left << setw(22) << phaseName(static_cast<Phase>(p)) << right << setw(8) << stats.phaseCalls[p]
+            << setw(14) << fixed << setprecision(3) << stats.phaseNanos[p] / 1e6 << endl;
+    }
+    out << left << setw(22) << "total (wall)" << right << setw(22) << wallSeconds * 1e3 << endl;
+    out.unsetf(ios::floatfield);
+    for (size_t c = 0; c < COUNTER_COUNT; c++)
+        out << left << setw(22) << counterName(static_cast<Counter>(c)) << right << setw(22) << stats.counters[c]
+            << endl;
+    out << "(phase times are summed over threads)" << endl;
+}
+
+void printStatsJson(ostream &out, const StatsSnapshot &stats, double wallSeconds) {
+    out << "{\"wall_ms\": " << wallSeconds * 1e3 << ", \"phases\": {";
+    bool first = true;
+    for (size_t p = 0; p < PHASE_COUNT; p++) {
+        if (!stats.phaseCalls[p])
+            continue;
+        out << (first ? "" : ", ") << '"' << phaseName(static_cast<Phase>(p)) << "\": {\"calls\": "
+            << stats.phaseCalls[p] << ", \"ms\": " << stats.phaseNanos[p] / 1e6 << "}";
+        first = false;
+    }
+    out << "}, \"counters\": {";
+    for (size_t c = 0; c < COUNTER_COUNT; c++)
+        out << (c ? ", " : "") << '"' << counterName(static_cast<Counter>(c)) << "\": " << stats.counters[c];
+    out << "}}" << endl;
+}
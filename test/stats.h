@@ -0,0 +1,154 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+using namespace std;
+
+// Pipeline instrumentation: scoped timers per phase and event counters,
+// reported by sql_parser --stats. Every thread counts into its own block,
+// so counting never contends; a report sums the blocks of all threads,
+// live and finished. Phase times are summed over threads as well, so with
+// parallel validation they are CPU time, not wall time. Hot loops count
+// into a local ParseCounters and flush it once per call.
+//
+// Building with -DSQL_NO_STATS compiles all of it out: the macros expand
+// to nothing and ParseCounters is empty.
+
+enum class Phase : uint8_t {
+    Lex, GrammarSets, TableBuild, Parse, Validate, Analyze, Execute,
+    WriteSymbolTable, WriteParseTree, WriteParsingTable, WriteGrammar,
+    Count
+};
+enum class Counter : uint8_t {
+    Tokens, TableLookups, StackPushes, StackPops, MaxStackDepth, Allocations, AllocatedBytes,
+    Count
+};
+const size_t PHASE_COUNT = static_cast<size_t>(Phase::Count);
+const size_t COUNTER_COUNT = static_cast<size_t>(Counter::Count);
+
+const char *phaseName(Phase p);
+const char *counterName(Counter c);
+
+// Totals over all threads.
+struct StatsSnapshot {
+    uint64_t phaseCalls[PHASE_COUNT] = {};
+    uint64_t phaseNanos[PHASE_COUNT] = {};
+    uint64_t counters[COUNTER_COUNT] = {};
+};
+
+#ifdef SQL_NO_STATS
+const bool STATS_ENABLED = false;
+#else
+const bool STATS_ENABLED = true;
+#endif
+
+StatsSnapshot collectStats();
+// A table for people, or one JSON object; `wallSeconds` is the whole run.
+void printStats(ostream &out, const StatsSnapshot &stats, double wallSeconds);
+void printStatsJson(ostream &out, const StatsSnapshot &stats, double wallSeconds);
+
+#ifndef SQL_NO_STATS
+
+// One thread's block. Only the owning thread writes it, with a relaxed
+// load and store (a plain add, no locked instruction); the values are
+// atomic so that collectStats() can read them while the thread runs.
+struct ThreadStats {
+    atomic<uint64_t> phaseCalls[PHASE_COUNT];
+    atomic<uint64_t> phaseNanos[PHASE_COUNT];
+    atomic<uint64_t> counters[COUNTER_COUNT];
+    ThreadStats *next;      // Registry of live threads.
+};
+
+extern thread_local ThreadStats *currentThreadStats;
+ThreadStats *registerThreadStats();
+
+inline ThreadStats &threadStats() {
+    ThreadStats *s = currentThreadStats;
+    return s ? *s : *registerThreadStats();
+}
+inline void bump(atomic<uint64_t> &v, uint64_t n) {
+    v.store(v.load(memory_order_relaxed) + n, memory_order_relaxed);
+}
+inline void addStat(ThreadStats &s, Counter c, uint64_t n) {
+    bump(s.counters[static_cast<size_t>(c)], n);
+}
+inline void addStat(Counter c, uint64_t n) {
+    addStat(threadStats(), c, n);
+}
+inline void maxStat(ThreadStats &s, Counter c, uint64_t v) {
+    atomic<uint64_t> &m = s.counters[static_cast<size_t>(c)];
+    if (v > m.load(memory_order_relaxed))
+        m.store(v, memory_order_relaxed);
+}
+
+// Adds the time from construction to destruction to `phase`.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase) : phase(phase), start(chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        ThreadStats &s = threadStats();
+        bump(s.phaseCalls[static_cast<size_t>(phase)], 1);
+        bump(s.phaseNanos[static_cast<size_t>(phase)], ns);
+    }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+    Phase phase;
+    chrono::steady_clock::time_point start;
+};
+
+// Counters of a parser loop over `stack`, kept in locals; the loop calls
+// flush() before each return. (Not a destructor: that would pin them in
+// memory for the exception path, which costs the loop far more than the
+// counting.) Pops are not counted as they happen: every symbol pushed is
+// popped except those still on the stack at the end.
+template <class Stack>
+struct ParseCounters {
+    const Stack &stack;
+    uint64_t lookups = 0, pushes = 0;
+    size_t maxDepth = 0;
+
+    explicit ParseCounters(const Stack &stack) : stack(stack) {}
+    void lookup() { lookups++; }
+    // After pushing n symbols.
+    void pushed(size_t n) {
+        pushes += n;
+        maxDepth = max(maxDepth, stack.size());
+    }
+    void flush() {
+        ThreadStats &s = threadStats();
+        addStat(s, Counter::TableLookups, lookups);
+        addStat(s, Counter::StackPushes, pushes);
+        addStat(s, Counter::StackPops, pushes - stack.size());
+        maxStat(s, Counter::MaxStackDepth, maxDepth);
+    }
+};
+
+#define STATS_CONCAT_(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_(a, b)
+#define STATS_PHASE(phase) PhaseTimer STATS_CONCAT(phaseTimer_, __LINE__)(phase)
+#define STATS_ADD(counter, n) addStat(counter, n)
+
+#else
+
+template <class Stack>
+struct ParseCounters {
+    explicit ParseCounters(const Stack &) {}
+    void lookup() {}
+    void pushed(size_t) {}
+    void flush() {}
+};
+
+#define STATS_PHASE(phase) ((void)0)
+#define STATS_ADD(counter, n) ((void)0)
+
+#endif // SQL_NO_STATS
+
+#endif // STATS_H
@@ -0,0 +1,614 @@
+#include "store.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include "stats.h"
+using namespace std;
+
+static string quoted(uint32_t symbol) {
+    return "'" + string(symbolText(symbol)) + "'";
+}
+
+// A NUMBER lexeme as an exact integer; false if it has a '.' or does not
+// fit in an int64_t.
+static bool parseInteger(string_view text, int64_t &out) {
+    auto r = from_chars(text.data(), text.data() + text.size(), out);
+    return r.ec == errc() && r.ptr == text.data() + text.size();
+}
+
+// A NUMBER lexeme as the nearest double; false if it overflows.
+static bool parseDecimal(string_view text, double &out) {
+    return from_chars(text.data(), text.data() + text.size(), out).ec == errc();
+}
+
+// The least integer >= x, a non-negative literal; false if there is none.
+static bool integerAtLeast(bool integral, int64_t integer, double decimal, int64_t &out) {
+    if (integral) {
+        out = integer;
+        return true;
+    }
+    double c = ceil(decimal);
+    if (c >= 9223372036854775808.0)
+        return false;
+    out = static_cast<int64_t>(c);
+    return true;
+}
+
+// The greatest integer <= x, a non-negative literal, at most INT64_MAX.
+static int64_t integerAtMost(bool integral, int64_t integer, double decimal) {
+    if (integral)
+        return integer;
+    double f = floor(decimal);
+    return f >= 9223372036854775808.0 ? numeric_limits<int64_t>::max() : static_cast<int64_t>(f);
+}
+
+// SQL LIKE: '%' matches any run of characters, '_' any one character.
+// Backtracks only to the last '%', so it runs in O(text * pattern) at worst.
+static bool likeMatch(string_view text, string_view pattern) {
+    size_t t = 0, p = 0, star = string_view::npos, resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '%') {
+            star = p++;
+            resume = t;
+        } else if (p < pattern.size() && (pattern[p] == '_' || pattern[p] == text[t])) {
+            t++;
+            p++;
+        } else if (star != string_view::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '%')
+        p++;
+    return p == pattern.size();
+}
+
+void KeyIndex::place(Slot slot) {
+    size_t mask = slots.size() - 1;
+    size_t s = slot.hash & mask;
+    while (slots[s].row != NO_ID)
+        s = (s + 1) & mask;
+    slots[s] = slot;
+}
+
+void KeyIndex::insert(uint32_t hash, uint32_t row) {
+    if (++used * 4 > slots.size() * 3) {
+        vector<Slot> old(slots.size() * 2, Slot{0, NO_ID});
+        old.swap(slots);
+        for (const Slot &slot : old) {
+            if (slot.row != NO_ID)
+                place(slot);
+        }
+    }
+    place({hash, row});
+}
+
+size_t ColumnStore::totalRows() const {
+    size_t total = 0;
+    for (size_t r : rows)
+        total += r;
+    return total;
+}
+
+size_t ColumnStore::dataBytes() const {
+    size_t total = 0;
+    for (const auto &c : columns)
+        total += c.integers.capacityBytes() + c.decimals.capacityBytes() + c.texts.capacityBytes();
+    return total;
+}
+
+size_t ColumnStore::indexBytes() const {
+    size_t total = 0;
+    for (size_t t = 0; t < indexes.size(); t++) {
+        if (catalog.tables.primaryKey[t] != NO_ID)
+            total += indexes[t].bytes();
+    }
+    return total;
+}
+
+uint64_t ColumnStore::keyOf(ColumnType type, const Cell &cell) {
+    switch (type) {
+        case ColumnType::Integer:
+            return static_cast<uint64_t>(cell.integer);
+        case ColumnType::Decimal: {
+            uint64_t bits;
+            memcpy(&bits, &cell.decimal, sizeof bits);
+            return bits;
+        }
+        default:
+            return cell.text;
+    }
+}
+
+uint64_t ColumnStore::keyAt(uint32_t column, size_t row) const {
+    Cell cell;
+    ColumnType type = catalog.columns.type[column];
+    switch (type) {
+        case ColumnType::Integer: cell.integer = columns[column].integers[row]; break;
+        case ColumnType::Decimal: cell.decimal = columns[column].decimals[row]; break;
+        case ColumnType::Text: cell.text = columns[column].texts[row]; break;
+    }
+    return keyOf(type, cell);
+}
+
+// Converts value `value` of an INSERT to the type of `column`. The semantic
+// pass has checked that it is a literal of the right kind.
+bool ColumnStore::convert(const Ast &ast, uint32_t value, uint32_t column, Cell &cell, string &error) {
+    string_view text = ast.str(ast.values.text[value]);
+    switch (catalog.columns.type[column]) {
+        case ColumnType::Integer:
+            if (parseInteger(text, cell.integer))
+                return true;
+            break;
+        case ColumnType::Decimal:
+            if (parseDecimal(text, cell.decimal))
+                return true;
+            break;
+        case ColumnType::Text:
+            cell.text = ast.values.symbol[value];
+            if (cell.text == NO_SYMBOL)
+                cell.text = strings.intern(SymbolKind::String, text);
+            return true;
+    }
+    error = "Execution Error: number " + string(text) + " is out of range for column " +
+            quoted(catalog.columns.name[column]) + " (" + columnTypeName(catalog.columns.type[column]) + ").";
+    return false;
+}
+
+// Converts all values and checks the primary key first, so a failing
+// INSERT leaves the table as it was.
+bool ColumnStore::insert(const Ast &ast, uint32_t row, uint32_t table, const Resolution &resolution,
+                         string &error) {
+    const Ast::Inserts &ins = ast.inserts;
+    uint32_t first = catalog.tables.firstColumn[table];
+    uint32_t count = catalog.tables.columnCount[table];
+    uint32_t keyColumn = catalog.tables.primaryKey[table];
+    uint32_t keyValue = NO_ID;
+    staged.assign(count, Cell());
+    for (uint32_t v = 0; v < ins.valueCount[row]; v++) {
+        uint32_t column = ins.columnCount[row] ? resolution.names[ins.firstColumn[row] + v] : first + v;
+        if (!convert(ast, ins.firstValue[row] + v, column, staged[column - first], error))
+            return false;
+        if (column == keyColumn)
+            keyValue = ins.firstValue[row] + v;
+    }
+
+    uint32_t hash = 0;
+    if (keyColumn != NO_ID) {
+        // The semantic pass has checked that the key gets a value.
+        ColumnType type = catalog.columns.type[keyColumn];
+        uint64_t key = keyOf(type, staged[keyColumn - first]);
+        hash = keyHash(key);
+        if (indexes[table].find(hash, [&](uint32_t r) { return keyAt(keyColumn, r) == key; }) != NO_ID) {
+            string_view text = ast.str(ast.values.text[keyValue]);
+            error = "Execution Error: duplicate primary key " +
+                    (type == ColumnType::Text ? "'" + string(text) + "'" : string(text)) + " in table " +
+                    quoted(catalog.tables.name[table]) + ".";
+            return false;
+        }
+        if (rows[table] >= NO_ID) {
+            error = "Execution Error: table " + quoted(catalog.tables.name[table]) + " is full.";
+            return false;
+        }
+    }
+    for (uint32_t c = 0; c < count; c++) {
+        Column &column = columns[first + c];
+        switch (catalog.columns.type[first + c]) {
+            case ColumnType::Integer: column.integers.push_back(staged[c].integer); break;
+            case ColumnType::Decimal: column.decimals.push_back(staged[c].decimal); break;
+            case ColumnType::Text: column.texts.push_back(staged[c].text); break;
+        }
+    }
+    if (keyColumn != NO_ID)
+        indexes[table].insert(hash, static_cast<uint32_t>(rows[table]));
+    rows[table]++;
+    return true;
+}
+
+// The key that literal `value` of `ast` would have in a column of `type`;
+// false if no cell of such a column can equal it.
+bool ColumnStore::literalKey(const Ast &ast, uint32_t value, const Scalar &literal, ColumnType type,
+                             uint64_t &key) const {
+    Cell cell;
+    switch (type) {
+        case ColumnType::Integer:   // A whole number, such as 3 or 3.0.
+            if (!integerAtLeast(literal.integral, literal.integer, literal.decimal, cell.integer) ||
+                cell.integer != integerAtMost(literal.integral, literal.integer, literal.decimal))
+                return false;
+            break;
+        case ColumnType::Decimal:
+            cell.decimal = literal.decimal;
+            break;
+        case ColumnType::Text:
+            // A string no one interned is in no column.
+            cell.text = ast.values.symbol[value];
+            if (cell.text == NO_SYMBOL)
+                cell.text = symbolPool().find(SymbolKind::String, literal.text);
+            if (cell.text == NO_SYMBOL)
+                return false;
+            break;
+    }
+    key = keyOf(type, cell);
+    return true;
+}
+
+void ColumnStore::compileFilter(const Ast &ast, uint32_t row, uint32_t table, const Resolution &resolution) {
+    typedef Filter::Mode Mode;
+    const Ast::Selects &sel = ast.selects;
+    Filter &f = filter;
+    f.condition = sel.condition[row];
+    f.mode = Mode::All;
+    if (f.condition == ConditionKind::None)
+        return;
+    f.column = resolution.conditionColumn[row];
+    ColumnType type = catalog.columns.type[f.column];
+    f.text = type == ColumnType::Text;
+    f.operands.clear();
+    bool literals = true;
+    for (uint32_t v = sel.firstValue[row]; v < sel.firstValue[row] + sel.valueCount[row]; v++) {
+        Scalar s;
+        uint32_t other = resolution.valueColumn[v];
+        if (other == NO_ID) {
+            s.text = ast.str(ast.values.text[v]);
+            if (!f.text) {
+                s.integral = parseInteger(s.text, s.integer);
+                if (!parseDecimal(s.text, s.decimal))
+                    s.decimal = HUGE_VAL;
+            }
+        }
+        literals &= other == NO_ID;
+        f.operands.push_back({other, s});
+    }
+    f.mode = Mode::Rows;
+    if (!literals)
+        return;
+
+    // = and IN on the primary key: index lookups. IN elsewhere, and = on
+    // strings: a set of keys.
+    const vector<pair<uint32_t, Scalar>> &ops = f.operands;
+    bool lookup = f.column == catalog.tables.primaryKey[table];
+    if (f.condition == ConditionKind::In || (f.condition == ConditionKind::Equal && (lookup || f.text))) {
+        f.found.clear();
+        f.integers.clear();
+        f.decimals.clear();
+        f.texts.clear();
+        for (uint32_t i = 0; i < ops.size(); i++) {
+            uint64_t key;
+            if (!literalKey(ast, sel.firstValue[row] + i, ops[i].second, type, key))
+                continue;
+            if (lookup) {
+                uint32_t r = indexes[table].find(keyHash(key), [&](uint32_t r) { return keyAt(f.column, r) == key; });
+                if (r != NO_ID)
+                    f.found.push_back(r);
+            } else if (type == ColumnType::Integer) {
+                f.integers.push_back(static_cast<int64_t>(key));
+            } else if (type == ColumnType::Decimal) {
+                double d;
+                memcpy(&d, &key, sizeof d);
+                f.decimals.push_back(d);
+            } else {
+                f.texts.push_back(static_cast<uint32_t>(key));
+            }
+        }
+        // In row order, each row once, as a scan would return them.
+        sort(f.found.begin(), f.found.end());
+        f.found.erase(unique(f.found.begin(), f.found.end()), f.found.end());
+        sort(f.integers.begin(), f.integers.end());
+        sort(f.decimals.begin(), f.decimals.end());
+        sort(f.texts.begin(), f.texts.end());
+        f.mode = lookup ? Mode::Lookup : type == ColumnType::Integer ? Mode::IntegerSet
+               : type == ColumnType::Decimal ? Mode::DecimalSet : Mode::TextSet;
+        if (f.found.empty() && f.integers.empty() && f.decimals.empty() && f.texts.empty())
+            f.mode = Mode::Nothing;
+        return;
+    }
+    if (f.text || f.condition == ConditionKind::Like)
+        return;     // Orders strings: row by row.
+
+    // Comparisons and BETWEEN on a number column: an inclusive range.
+    const Scalar &a = ops[0].second;
+    const Scalar &b = ops.size() > 1 ? ops[1].second : a;
+    if (type == ColumnType::Decimal) {
+        f.mode = Mode::DecimalRange;
+        switch (f.condition) {
+            case ConditionKind::Equal: f.lowDecimal = f.highDecimal = a.decimal; break;
+            case ConditionKind::Greater: f.lowDecimal = nextafter(a.decimal, HUGE_VAL); f.highDecimal = HUGE_VAL; break;
+            case ConditionKind::Less: f.lowDecimal = -HUGE_VAL; f.highDecimal = nextafter(a.decimal, -HUGE_VAL); break;
+            default: f.lowDecimal = a.decimal; f.highDecimal = b.decimal; break;
+        }
+        if (!(f.lowDecimal <= f.highDecimal))
+            f.mode = Mode::Nothing;
+        return;
+    }
+    f.mode = Mode::IntegerRange;
+    const int64_t MAX = numeric_limits<int64_t>::max();
+    int64_t aLow = 0, aHigh = integerAtMost(a.integral, a.integer, a.decimal);
+    bool aAny = integerAtLeast(a.integral, a.integer, a.decimal, aLow);
+    bool any = true;
+    switch (f.condition) {
+        case ConditionKind::Equal:      // Nothing if a is not whole.
+            any = aAny;
+            f.low = aLow;
+            f.high = aHigh;
+            break;
+        case ConditionKind::Greater:    // v > a: v >= floor(a) + 1.
+            any = aHigh < MAX;
+            f.low = aHigh + 1;
+            f.high = MAX;
+            break;
+        case ConditionKind::Less:       // v < a: v <= ceil(a) - 1.
+            f.low = NULL_INTEGER + 1;
+            f.high = aAny ? aLow - 1 : MAX;
+            break;
+        default:
+            any = aAny;
+            f.low = aLow;
+            f.high = integerAtMost(b.integral, b.integer, b.decimal);
+            break;
+    }
+    if (!any || f.low > f.high)
+        f.mode = Mode::Nothing;
+}
+
+ColumnStore::Scalar ColumnStore::cellAt(uint32_t column, size_t row) const {
+    Scalar s;
+    switch (catalog.columns.type[column]) {
+        case ColumnType::Integer:
+            s.integer = columns[column].integers[row];
+            s.null = s.integer == NULL_INTEGER;
+            s.integral = true;
+            s.decimal = static_cast<double>(s.integer);
+            break;
+        case ColumnType::Decimal:
+            s.decimal = columns[column].decimals[row];
+            s.null = isnan(s.decimal);
+            break;
+        case ColumnType::Text: {
+            uint32_t symbol = columns[column].texts[row];
+            s.null = symbol == NULL_TEXT;
+            if (!s.null)
+                s.text = symbolText(symbol);
+            break;
+        }
+    }
+    return s;
+}
+
+// The general case: any condition, operands may be columns.
+bool ColumnStore::matches(size_t row) const {
+    Scalar a = cellAt(filter.column, row);
+    if (a.null)
+        return false;
+    bool text = filter.text;
+    // -1, 0 or 1 as a is less than, equal to or greater than operand i;
+    // 2 if the operand is NULL.
+    auto compare = [&](size_t i) {
+        const auto &op = filter.operands[i];
+        Scalar b = op.first == NO_ID ? op.second : cellAt(op.first, row);
+        if (b.null)
+            return 2;
+        if (text) {
+            int c = a.text.compare(b.text);
+            return (c > 0) - (c < 0);
+        }
+        if (a.integral && b.integral)
+            return (a.integer > b.integer) - (a.integer < b.integer);
+        return (a.decimal > b.decimal) - (a.decimal < b.decimal);
+    };
+    switch (filter.condition) {
+        case ConditionKind::Equal: return compare(0) == 0;
+        case ConditionKind::Greater: return compare(0) == 1;
+        case ConditionKind::Less: return compare(0) == -1;
+        case ConditionKind::Between: {
+            int low = compare(0), high = compare(1);
+            return (low == 0 || low == 1) && high <= 0;
+        }
+        case ConditionKind::In:
+            for (size_t i = 0; i < filter.operands.size(); i++) {
+                if (compare(i) == 0)
+                    return true;
+            }
+            return false;
+        case ConditionKind::Like: {
+            const auto &op = filter.operands[0];
+            Scalar pattern = op.first == NO_ID ? op.second : cellAt(op.first, row);
+            return !pattern.null && likeMatch(a.text, pattern.text);
+        }
+        default: return true;
+    }
+}
+
+// Writes to `selected` the offsets, from `begin`, of the rows of the chunk
+// [begin, begin + count) that pass the filter; returns how many. The fast
+// modes read one column's chunk as an array, without branches on the data.
+size_t ColumnStore::applyFilter(size_t begin, size_t count, uint32_t *selected) const {
+    typedef Filter::Mode Mode;
+    const Filter &f = filter;
+    size_t chunk = begin / CHUNK_ROWS;
+    size_t n = 0;
+    switch (f.mode) {
+        case Mode::All:
+            for (size_t i = 0; i < count; i++)
+                selected[i] = static_cast<uint32_t>(i);
+            return count;
+        case Mode::Nothing:
+            return 0;
+        case Mode::IntegerRange: {
+            const int64_t *v = columns[f.column].integers.chunk(chunk);
+            uint64_t width = static_cast<uint64_t>(f.high) - static_cast<uint64_t>(f.low);
+            for (size_t i = 0; i < count; i++) {
+                selected[n] = static_cast<uint32_t>(i);
+                n += static_cast<uint64_t>(v[i]) - static_cast<uint64_t>(f.low) <= width;
+            }
+            return n;
+        }
+        case Mode::DecimalRange: {
+            const double *v = columns[f.column].decimals.chunk(chunk);
+            for (size_t i = 0; i < count; i++) {
+                selected[n] = static_cast<uint32_t>(i);
+                n += (v[i] >= f.lowDecimal) & (v[i] <= f.highDecimal);
+            }
+            return n;
+        }
+        case Mode::IntegerSet: {
+            const int64_t *v = columns[f.column].integers.chunk(chunk);
+            for (size_t i = 0; i < count; i++) {
+                selected[n] = static_cast<uint32_t>(i);
+                n += binary_search(f.integers.begin(), f.integers.end(), v[i]);
+            }
+            return n;
+        }
+        case Mode::DecimalSet: {
+            const double *v = columns[f.column].decimals.chunk(chunk);
+            for (size_t i = 0; i < count; i++) {
+                selected[n] = static_cast<uint32_t>(i);
+                // NULL is NaN, which binary_search would find in any set.
+                n += !isnan(v[i]) && binary_search(f.decimals.begin(), f.decimals.end(), v[i]);
+            }
+            return n;
+        }
+        case Mode::TextSet: {
+            const uint32_t *v = columns[f.column].texts.chunk(chunk);
+            for (size_t i = 0; i < count; i++) {
+                selected[n] = static_cast<uint32_t>(i);
+                n += binary_search(f.texts.begin(), f.texts.end(), v[i]);
+            }
+            return n;
+        }
+        default:
+            for (size_t i = 0; i < count; i++) {
+                selected[n] = static_cast<uint32_t>(i);
+                n += matches(begin + i);
+            }
+            return n;
+    }
+}
+
+void ColumnStore::appendCell(uint32_t column, size_t row) {
+    char digits[32];
+    switch (catalog.columns.type[column]) {
+        case ColumnType::Integer: {
+            int64_t v = columns[column].integers[row];
+            if (v == NULL_INTEGER) {
+                buffer += "NULL";
+                return;
+            }
+            buffer.append(digits, to_chars(digits, digits + sizeof digits, v).ptr);
+            return;
+        }
+        case ColumnType::Decimal: {
+            double v = columns[column].decimals[row];
+            if (isnan(v)) {
+                buffer += "NULL";
+                return;
+            }
+            buffer.append(digits, to_chars(digits, digits + sizeof digits, v).ptr);
+            return;
+        }
+        case ColumnType::Text: {
+            uint32_t v = columns[column].texts[row];
+            if (v == NULL_TEXT) {
+                buffer += "NULL";
+                return;
+            }
+            // Doubles each quote; appends the runs between them whole.
+            string_view text = symbolText(v);
+            buffer += '\'';
+            for (size_t quote; (quote = text.find('\'')) != string_view::npos; text.remove_prefix(quote + 1))
+                buffer.append(text.data(), quote + 1) += '\'';
+            buffer.append(text.data(), text.size()) += '\'';
+            return;
+        }
+    }
+}
+
+// The projected columns of `row`, tab-separated, and a newline.
+void ColumnStore::appendRow(size_t row) {
+    for (size_t p = 0; p < projection.size(); p++) {
+        if (p)
+            buffer += '\t';
+        appendCell(projection[p], row);
+    }
+    buffer += '\n';
+}
+
+void ColumnStore::flush(ostream &out) {
+    out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void ColumnStore::select(const Ast &ast, uint32_t row, uint32_t table, const Resolution &resolution,
+                         ostream &out) {
+    const Ast::Selects &sel = ast.selects;
+    projection.clear();
+    if (sel.columnCount[row]) {
+        for (uint32_t n = sel.firstColumn[row]; n < sel.firstColumn[row] + sel.columnCount[row]; n++)
+            projection.push_back(resolution.names[n]);
+    } else {
+        for (uint32_t c = 0; c < catalog.tables.columnCount[table]; c++)
+            projection.push_back(catalog.tables.firstColumn[table] + c);
+    }
+    for (size_t p = 0; p < projection.size(); p++) {
+        if (p)
+            buffer += '\t';
+        buffer += symbolText(catalog.columns.name[projection[p]]);
+    }
+    buffer += '\n';
+
+    compileFilter(ast, row, table, resolution);
+    size_t matched = 0;
+    if (filter.mode == Filter::Mode::Lookup) {
+        for (uint32_t r : filter.found)
+            appendRow(r);
+        matched = filter.found.size();
+    }
+    for (size_t begin = 0; begin < rows[table] && filter.mode != Filter::Mode::Lookup; begin += CHUNK_ROWS) {
+        selected.resize(CHUNK_ROWS);
+        size_t n = applyFilter(begin, min(CHUNK_ROWS, rows[table] - begin), selected.data());
+        for (size_t i = 0; i < n; i++) {
+            appendRow(begin + selected[i]);
+            if (buffer.size() >= (1 << 16))
+                flush(out);
+        }
+        matched += n;
+    }
+    buffer += '(' + to_string(matched) + (matched == 1 ? " row)\n" : " rows)\n");
+    returned += matched;
+}
+
+size_t ColumnStore::execute(const Ast &ast, const Resolution &resolution, ostream &out,
+                            vector<StatementError> &errors) {
+    STATS_PHASE(Phase::Execute);
+    // The semantic pass has added the tables of the Ast to the catalog.
+    columns.resize(catalog.columnCount());
+    rows.resize(catalog.tableCount(), 0);
+    indexes.resize(catalog.tableCount());
+    size_t failed = 0;
+    string error;
+    for (size_t s = 0; s < ast.size(); s++) {
+        uint32_t table = resolution.table[s];
+        if (table == NO_ID)
+            continue;
+        uint32_t row = ast.statements.row[s];
+        switch (ast.statements.kind[s]) {
+            case StatementKind::CreateTable:
+                break;
+            case StatementKind::Insert:
+                if (!insert(ast, row, table, resolution, error)) {
+                    errors.push_back({ast.statements.offset[s], move(error)});
+                    error.clear();
+                    failed++;
+                    continue;
+                }
+                break;
+            default:
+                select(ast, row, table, resolution, out);
+                break;
+        }
+        executed++;
+    }
+    flush(out);
+    return failed;
+}
@@ -0,0 +1,197 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ast.h"
+#include "catalog.h"
+#include "parallel.h"
+#include "semantic.h"
+#include "symbols.h"
+using namespace std;
+
+// In-memory column store for the tables of a Catalog. Each column is one
+// typed array, split into chunks of CHUNK_ROWS values:
+//   INT      int64_t
+//   DECIMAL  double
+//   VARCHAR  uint32_t, the symbol of the string (symbols.h), so equal
+//            strings are stored once and compare as integers.
+// Columns an INSERT does not list are NULL, stored in-band as NULL_INTEGER,
+// NaN or NULL_TEXT; no literal can produce these (numbers have no sign).
+// A table with a primary key also has a KeyIndex on it, which keeps the
+// key unique and answers `WHERE key = v` and `WHERE key IN (...)` without
+// scanning.
+
+const int64_t NULL_INTEGER = numeric_limits<int64_t>::min();
+const uint32_t NULL_TEXT = NO_SYMBOL;
+
+// One column's values. Only the last chunk grows; the first grows by
+// doubling up to CHUNK_ROWS and the others are allocated full, so an
+// append copies at most one chunk and small tables stay small. Row r is
+// chunk(r >> CHUNK_BITS)[r & (CHUNK_ROWS - 1)].
+template <class T>
+class ChunkedColumn {
+public:
+    static constexpr size_t CHUNK_BITS = 16;
+    static constexpr size_t CHUNK_ROWS = size_t(1) << CHUNK_BITS;
+
+    void push_back(T value) {
+        if (chunks.empty() || chunks.back().size() == CHUNK_ROWS) {
+            chunks.emplace_back();
+            if (chunks.size() > 1)
+                chunks.back().reserve(CHUNK_ROWS);
+        }
+        chunks.back().push_back(value);
+    }
+    T operator[](size_t row) const { return chunks[row >> CHUNK_BITS][row & (CHUNK_ROWS - 1)]; }
+    const T *chunk(size_t c) const { return chunks[c].data(); }
+    size_t chunkCount() const { return chunks.size(); }
+    // Bytes allocated for values.
+    size_t capacityBytes() const {
+        size_t total = 0;
+        for (const auto &c : chunks)
+            total += c.capacity() * sizeof(T);
+        return total;
+    }
+
+private:
+    vector<vector<T>> chunks;
+};
+
+// Open-addressing hash index from a primary key to its row, with linear
+// probing, at most 3/4 full. A slot holds the row and the high half of the
+// key's hash, which also picks the slot, so growing reads no keys; the key
+// itself stays in its column. 8 bytes per slot.
+class KeyIndex {
+public:
+    KeyIndex() : slots(16, Slot{0, NO_ID}) {}
+
+    // The row with hash `hash` for which `matches(row)` is true, or NO_ID.
+    template <class Matches>
+    uint32_t find(uint32_t hash, Matches matches) const {
+        size_t mask = slots.size() - 1;
+        for (size_t s = hash & mask;; s = (s + 1) & mask) {
+            if (slots[s].row == NO_ID)
+                return NO_ID;
+            if (slots[s].hash == hash && matches(slots[s].row))
+                return slots[s].row;
+        }
+    }
+    // Adds a row whose key is not in the index.
+    void insert(uint32_t hash, uint32_t row);
+    size_t size() const { return used; }
+    size_t bytes() const { return slots.size() * sizeof(Slot); }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t row;       // NO_ID: empty.
+    };
+    void place(Slot slot);
+
+    vector<Slot> slots;     // Power of two.
+    size_t used = 0;
+};
+
+class ColumnStore {
+public:
+    static constexpr size_t CHUNK_ROWS = ChunkedColumn<int64_t>::CHUNK_ROWS;
+
+    explicit ColumnStore(const Catalog &catalog) : catalog(catalog) {}
+
+    // Executes, in order, the statements of `ast` that the semantic pass
+    // resolved into `resolution` (the others are skipped): CREATE TABLE
+    // gives the table its (empty) columns, INSERT appends a row and SELECT
+    // scans the table and prints the selected columns of the matching rows
+    // to `out`, tab-separated, after a header line and before a row count.
+    // An INSERT fails if a number does not fit its column or the primary
+    // key is taken; it then appends an error to `errors` and leaves the
+    // table as it was. Returns how many statements failed.
+    size_t execute(const Ast &ast, const Resolution &resolution, ostream &out, vector<StatementError> &errors);
+
+    size_t rowCount(uint32_t table) const { return table < rows.size() ? rows[table] : 0; }
+    size_t totalRows() const;
+    // Bytes allocated for column values (string texts are in the pool).
+    size_t dataBytes() const;
+    size_t indexBytes() const;
+    size_t statementsExecuted() const { return executed; }
+    size_t rowsReturned() const { return returned; }
+
+private:
+    struct Column {
+        ChunkedColumn<int64_t> integers;
+        ChunkedColumn<double> decimals;
+        ChunkedColumn<uint32_t> texts;
+    };
+    // A value of an INSERT, converted to its column's type.
+    struct Cell {
+        int64_t integer = NULL_INTEGER;
+        double decimal = NAN;
+        uint32_t text = NULL_TEXT;
+    };
+    // A value for the general WHERE evaluation: a column's cell or a literal.
+    struct Scalar {
+        bool null = false;
+        bool integral = false;      // Numbers: `integer` is exact.
+        int64_t integer = 0;
+        double decimal = 0;
+        string_view text;
+    };
+    // A compiled WHERE clause. With literals only, = and IN on the primary
+    // key become index lookups, and other conditions on numbers a range or
+    // a set tested in a tight loop over a chunk; the rest are evaluated row
+    // by row.
+    struct Filter {
+        enum class Mode : uint8_t {
+            All, Nothing, Lookup, IntegerRange, DecimalRange, IntegerSet, DecimalSet, TextSet, Rows
+        } mode = Mode::All;
+        uint32_t column = NO_ID;
+        bool text = false;
+        vector<uint32_t> found;                 // Lookup: the rows, ascending.
+        int64_t low = 0, high = 0;              // IntegerRange, inclusive.
+        double lowDecimal = 0, highDecimal = 0; // DecimalRange, inclusive.
+        vector<int64_t> integers;               // Sets, sorted.
+        vector<double> decimals;
+        vector<uint32_t> texts;
+        ConditionKind condition = ConditionKind::None;      // Rows:
+        vector<pair<uint32_t, Scalar>> operands;            // column ID or NO_ID and literal.
+    };
+
+    bool insert(const Ast &ast, uint32_t row, uint32_t table, const Resolution &resolution, string &error);
+    bool convert(const Ast &ast, uint32_t value, uint32_t column, Cell &cell, string &error);
+    // A primary key value as 64 bits: the integer, the bits of the double
+    // or the symbol.
+    static uint64_t keyOf(ColumnType type, const Cell &cell);
+    uint64_t keyAt(uint32_t column, size_t row) const;
+    static uint32_t keyHash(uint64_t key) { return static_cast<uint32_t>(mix64(key) >> 32); }
+    void select(const Ast &ast, uint32_t row, uint32_t table, const Resolution &resolution, ostream &out);
+    void compileFilter(const Ast &ast, uint32_t row, uint32_t table, const Resolution &resolution);
+    bool literalKey(const Ast &ast, uint32_t value, const Scalar &literal, ColumnType type, uint64_t &key) const;
+    size_t applyFilter(size_t begin, size_t count, uint32_t *selected) const;
+    bool matches(size_t row) const;
+    Scalar cellAt(uint32_t column, size_t row) const;
+    void appendRow(size_t row);
+    void appendCell(uint32_t column, size_t row);
+    void flush(ostream &out);
+
+    const Catalog &catalog;
+    vector<Column> columns;     // [column ID]
+    vector<size_t> rows;        // [table ID]
+    vector<KeyIndex> indexes;   // [table ID]; unused without a primary key.
+    size_t executed = 0;
+    size_t returned = 0;
+    // Scratch, kept between statements.
+    vector<Cell> staged;            // The row being inserted.
+    vector<uint32_t> projection;    // Column IDs a SELECT prints.
+    vector<uint32_t> selected;      // Matching rows of the chunk being scanned.
+    Filter filter;
+    SymbolCache strings;
+    string buffer;                  // SELECT output not yet written.
+};
+
+#endif // STORE_H
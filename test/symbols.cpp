@@ -0,0 +1,193 @@
+#include "symbols.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+// Eight bytes per multiply, so long string literals hash quickly.
+uint64_t SymbolPool::hash(SymbolKind kind, string_view text) {
+    const uint64_t K = 0x9e3779b97f4a7c15ull;
+    uint64_t h = (static_cast<uint64_t>(kind) + 1) * K ^ text.size();
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t w;
+        memcpy(&w, text.data() + i, 8);
+        h = (h ^ w) * K;
+        h ^= h >> 32;
+    }
+    uint64_t w = 0;
+    memcpy(&w, text.data() + i, text.size() - i);
+    return mix64(h ^ w);
+}
+
+SymbolPool::SymbolPool()
+    : shards(new Shard[1u << SHARD_BITS]), directory(new atomic<Entry *>[1u << (32 - CHUNK_BITS)]) {
+    for (size_t s = 0; s < (1u << SHARD_BITS); s++)
+        shards[s].slots.assign(64, Slot{NO_SYMBOL, 0});
+    for (size_t c = 0; c < (1u << (32 - CHUNK_BITS)); c++)
+        directory[c].store(nullptr, memory_order_relaxed);
+}
+
+SymbolPool::~SymbolPool() {
+    for (size_t c = 0; c < (1u << (32 - CHUNK_BITS)); c++)
+        delete[] directory[c].load(memory_order_relaxed);
+}
+
+// The slot holding (kind, text), or the empty slot where it would go.
+// Called with the shard's lock held.
+size_t SymbolPool::probe(const Shard &shard, SymbolKind kind, string_view text, uint64_t h) const {
+    size_t mask = shard.slots.size() - 1;
+    uint32_t low = static_cast<uint32_t>(h);
+    for (size_t s = low & mask;; s = (s + 1) & mask) {
+        const Slot &slot = shard.slots[s];
+        if (slot.id == NO_SYMBOL)
+            return s;
+        if (slot.hash == low) {
+            const Entry &e = entry(slot.id);
+            if (e.kind == kind && string_view(e.data, e.length) == text)
+                return s;
+        }
+    }
+}
+
+// Copies `text` into the shard's arena. Blocks are 64 KB; longer texts get
+// a block of their own.
+const char *SymbolPool::store(Shard &shard, string_view text) {
+    const size_t BLOCK = 64 << 10;
+    shard.bytes += text.size();
+    if (text.size() > BLOCK / 4) {
+        shard.blocks.emplace_back(new char[text.size()]);
+        memcpy(shard.blocks.back().get(), text.data(), text.size());
+        return shard.blocks.back().get();
+    }
+    if (shard.left < text.size()) {
+        shard.blocks.emplace_back(new char[BLOCK]);
+        shard.cursor = shard.blocks.back().get();
+        shard.left = BLOCK;
+    }
+    char *p = shard.cursor;
+    memcpy(p, text.data(), text.size());
+    shard.cursor += text.size();
+    shard.left -= text.size();
+    return p;
+}
+
+SymbolPool::Entry *SymbolPool::chunkFor(uint32_t id) {
+    atomic<Entry *> &slot = directory[id >> CHUNK_BITS];
+    Entry *chunk = slot.load(memory_order_acquire);
+    if (chunk)
+        return chunk;
+    lock_guard<mutex> guard(chunkLock);
+    chunk = slot.load(memory_order_relaxed);
+    if (!chunk) {
+        chunk = new Entry[1u << CHUNK_BITS];
+        slot.store(chunk, memory_order_release);
+    }
+    return chunk;
+}
+
+uint32_t SymbolPool::intern(SymbolKind kind, string_view text, uint64_t h) {
+    Shard &shard = shardOf(h);
+    lock_guard<mutex> guard(shard.lock);
+    size_t s = probe(shard, kind, text, h);
+    if (shard.slots[s].id != NO_SYMBOL)
+        return shard.slots[s].id;
+
+    uint32_t id = count.fetch_add(1, memory_order_relaxed);
+    if (id == NO_SYMBOL) {
+        cerr << "Error: more than " << NO_SYMBOL << " distinct symbols" << endl;
+        abort();
+    }
+    chunkFor(id)[id & ((1u << CHUNK_BITS) - 1)] = {store(shard, text), static_cast<uint32_t>(text.size()), kind};
+    shard.slots[s] = {id, static_cast<uint32_t>(h)};
+    if (++shard.used * 2 > shard.slots.size()) {
+        vector<Slot> old(shard.slots.size() * 2, Slot{NO_SYMBOL, 0});
+        old.swap(shard.slots);
+        size_t mask = shard.slots.size() - 1;
+        for (const Slot &slot : old) {
+            if (slot.id == NO_SYMBOL)
+                continue;
+            size_t t = slot.hash & mask;
+            while (shard.slots[t].id != NO_SYMBOL)
+                t = (t + 1) & mask;
+            shard.slots[t] = slot;
+        }
+    }
+    return id;
+}
+
+uint32_t SymbolPool::find(SymbolKind kind, string_view text) const {
+    uint64_t h = hash(kind, text);
+    const Shard &shard = shardOf(h);
+    lock_guard<mutex> guard(shard.lock);
+    return shard.slots[probe(shard, kind, text, h)].id;
+}
+
+size_t SymbolPool::textBytes() const {
+    size_t total = 0;
+    for (size_t s = 0; s < (1u << SHARD_BITS); s++) {
+        lock_guard<mutex> guard(shards[s].lock);
+        total += shards[s].bytes;
+    }
+    return total;
+}
+
+SymbolPool &symbolPool() {
+    static SymbolPool pool;
+    return pool;
+}
+
+uint32_t SymbolCache::intern(SymbolKind kind, string_view text) {
+    if (slots.empty())
+        slots.assign(SLOTS, Slot{0, nullptr, 0, NO_SYMBOL, SymbolKind::Identifier});
+    uint64_t h = SymbolPool::hash(kind, text);
+    Slot &slot = slots[h & (SLOTS - 1)];
+    if (slot.hash == h && slot.id != NO_SYMBOL && slot.kind == kind && slot.length == text.size() &&
+        memcmp(slot.data, text.data(), text.size()) == 0)
+        return slot.id;
+    SymbolPool &pool = symbolPool();
+    uint32_t id = pool.intern(kind, text, h);
+    string_view stored = pool.text(id);
+    slot = {h, stored.data(), static_cast<uint32_t>(stored.size()), id, kind};
+    return id;
+}
+
+IdMap::IdMap() : slots(16, Slot{0, NO_ID}) {}
+
+size_t IdMap::slotOf(uint64_t key) const {
+    size_t mask = slots.size() - 1;
+    for (size_t s = mix64(key) & mask;; s = (s + 1) & mask) {
+        if (slots[s].value == NO_ID || slots[s].key == key)
+            return s;
+    }
+}
+
+void IdMap::grow() {
+    vector<Slot> old(slots.size() * 2, Slot{0, NO_ID});
+    old.swap(slots);
+    for (const Slot &slot : old) {
+        if (slot.value != NO_ID)
+            slots[slotOf(slot.key)] = slot;
+    }
+}
+
+uint32_t IdMap::find(uint64_t key) const {
+    return slots[slotOf(key)].value;
+}
+
+bool IdMap::insert(uint64_t key, uint32_t value) {
+    size_t s = slotOf(key);
+    if (slots[s].value != NO_ID)
+        return false;
+    slots[s] = {key, value};
+    if (++used * 2 > slots.size())
+        grow();
+    return true;
+}
+
+void IdMap::clear() {
+    if (used)
+        fill(slots.begin(), slots.end(), Slot{0, NO_ID});
+    used = 0;
+}
@@ -0,0 +1,150 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "token.h"
+using namespace std;
+
+// Interned identifiers and literals. The process-wide SymbolPool maps each
+// distinct (kind, text) to a dense 32-bit symbol ID, 0, 1, 2, ..., and
+// stores the text once, in arenas that never move, so symbolText() stays
+// valid for the life of the process. Later stages compare and hash
+// symbols instead of bytes.
+
+enum class SymbolKind : uint8_t { Identifier, Number, String };
+
+const uint32_t NO_ID = UINT32_MAX;
+
+// Finalizer of MurmurHash3: spreads all input bits over the result.
+inline uint64_t mix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+// Thread-safe: the table is split into shards by hash, each with its own
+// lock, table of IDs and arena; texts are found by ID through a directory
+// of fixed-size chunks, without locking.
+class SymbolPool {
+public:
+    SymbolPool();
+    ~SymbolPool();
+    SymbolPool(const SymbolPool &) = delete;
+    SymbolPool &operator=(const SymbolPool &) = delete;
+
+    // The ID of (kind, text), adding it if it is new.
+    uint32_t intern(SymbolKind kind, string_view text) { return intern(kind, text, hash(kind, text)); }
+    uint32_t intern(SymbolKind kind, string_view text, uint64_t h);
+    // The ID of (kind, text), or NO_SYMBOL.
+    uint32_t find(SymbolKind kind, string_view text) const;
+
+    string_view text(uint32_t id) const {
+        const Entry &e = entry(id);
+        return string_view(e.data, e.length);
+    }
+    SymbolKind kind(uint32_t id) const { return entry(id).kind; }
+
+    size_t size() const { return count.load(memory_order_relaxed); }
+    // Bytes of text held in the arenas.
+    size_t textBytes() const;
+
+    static uint64_t hash(SymbolKind kind, string_view text);
+
+private:
+    struct Entry {
+        const char *data;
+        uint32_t length;
+        SymbolKind kind;
+    };
+    struct Slot {
+        uint32_t id;        // NO_SYMBOL: empty.
+        uint32_t hash;      // Low half of the symbol's hash.
+    };
+    struct Shard {
+        mutable mutex lock;
+        vector<Slot> slots;     // Power of two, at most half full.
+        size_t used = 0;
+        vector<unique_ptr<char[]>> blocks;
+        char *cursor = nullptr;
+        size_t left = 0;
+        size_t bytes = 0;
+    };
+    static const unsigned SHARD_BITS = 6;
+    static const unsigned CHUNK_BITS = 16;
+
+    const Entry &entry(uint32_t id) const {
+        return directory[id >> CHUNK_BITS].load(memory_order_acquire)[id & ((1u << CHUNK_BITS) - 1)];
+    }
+    Shard &shardOf(uint64_t h) const { return shards[h >> (64 - SHARD_BITS)]; }
+    size_t probe(const Shard &shard, SymbolKind kind, string_view text, uint64_t h) const;
+    const char *store(Shard &shard, string_view text);
+    Entry *chunkFor(uint32_t id);
+
+    unique_ptr<Shard[]> shards;
+    unique_ptr<atomic<Entry *>[]> directory;  // Chunks of 2^CHUNK_BITS entries.
+    mutex chunkLock;                          // Allocation of chunks.
+    atomic<uint32_t> count{0};
+};
+
+// The pool behind Lexer interning, the AST and the catalog.
+SymbolPool &symbolPool();
+
+inline string_view symbolText(uint32_t id) {
+    return symbolPool().text(id);
+}
+
+// A thread's view of the pool: a direct-mapped cache of the symbols it
+// interned last, checked without locking. Names repeat in every statement,
+// so most identifiers are found here. Not thread-safe.
+class SymbolCache {
+public:
+    uint32_t intern(SymbolKind kind, string_view text);
+
+private:
+    // A copy of the symbol's entry, so a hit reads only this slot.
+    struct Slot {
+        uint64_t hash;
+        const char *data;
+        uint32_t length;
+        uint32_t id;
+        SymbolKind kind;
+    };
+    static const size_t SLOTS = 1024;
+    vector<Slot> slots;     // Allocated on first use.
+};
+
+// Open-addressing map from 64-bit keys to 32-bit values (not NO_ID), with
+// linear probing. Keys are IDs or combinations of them, such as
+// (table, symbol).
+class IdMap {
+public:
+    IdMap();
+
+    uint32_t find(uint64_t key) const;
+    // Adds key -> value; false if the key is already present.
+    bool insert(uint64_t key, uint32_t value);
+    size_t size() const { return used; }
+    // Empties the map, keeping its capacity.
+    void clear();
+
+private:
+    struct Slot {
+        uint64_t key;
+        uint32_t value;     // NO_ID: empty.
+    };
+    size_t slotOf(uint64_t key) const;
+    void grow();
+
+    vector<Slot> slots;
+    size_t used = 0;
+};
+
+#endif // SYMBOLS_H
@@ -0,0 +1,270 @@
+#include "table_cache.h"
+#include "utils.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// File layout: this header, then the sections it points to, each at an
+// 8-byte aligned offset. Symbol names are stored as offsets into a blob of
+// NUL-terminated strings.
+struct LL1TableFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t tokenTypes;        // TOKEN_TYPE_COUNT of the writer.
+    uint64_t grammarHash;
+    uint64_t fileSize;
+    uint16_t numTerminals;
+    uint16_t numSymbols;
+    uint16_t numProductions;
+    uint16_t startSymbol;
+    uint16_t endTerminal;
+    uint16_t reserved[3];
+    uint32_t nameOffsets;       // uint32_t[numSymbols], into the name blob.
+    uint32_t names;
+    uint32_t namesSize;
+    uint32_t rowBase;           // uint32_t[numSymbols - numTerminals]
+    uint32_t entries;           // LL1Entry[numEntries]
+    uint32_t numEntries;
+    uint32_t productionLhs;
+    uint32_t rhsBegin;
+    uint32_t rhsSymbols;
+    uint32_t rhsSymbolCount;
+    uint32_t tokenTerminal;
+    uint32_t reserved2;
+};
+
+static const char LL1_TABLE_MAGIC[8] = {'S', 'Q', 'L', 'L', 'L', '1', 'T', '\0'};
+
+uint64_t grammarHash(const vector<Production>& grammar) {
+    uint64_t h = 14695981039346656037ull;
+    auto add = [&](const string &s) {
+        for (unsigned char c : s)
+            h = (h ^ c) * 1099511628211ull;
+        h = (h ^ 0) * 1099511628211ull;   // Separator.
+    };
+    for (const auto &prod : grammar) {
+        add(prod.lhs);
+        for (const auto &sym : prod.rhs)
+            add(sym);
+        h = (h ^ '\n') * 1099511628211ull;
+    }
+    return h;
+}
+
+// Appends `n` bytes at the next 8-byte boundary; returns their offset.
+static uint32_t appendSection(string &buf, const void *data, size_t n) {
+    buf.resize((buf.size() + 7) & ~size_t(7));
+    uint32_t offset = static_cast<uint32_t>(buf.size());
+    buf.append(static_cast<const char *>(data), n);
+    return offset;
+}
+
+bool writeLL1TableFile(const string &path, const LL1Table &t, uint64_t hash) {
+    LL1TableFileHeader h = {};
+    memcpy(h.magic, LL1_TABLE_MAGIC, sizeof h.magic);
+    h.version = LL1_TABLE_FILE_VERSION;
+    h.tokenTypes = TOKEN_TYPE_COUNT;
+    h.grammarHash = hash;
+    h.numTerminals = t.numTerminals;
+    h.numSymbols = t.numSymbols;
+    h.numProductions = t.numProductions;
+    h.startSymbol = t.startSymbol;
+    h.endTerminal = t.endTerminal;
+
+    string blob;
+    vector<uint32_t> nameOffsets;
+    for (size_t i = 0; i < t.numSymbols; i++) {
+        nameOffsets.push_back(static_cast<uint32_t>(blob.size()));
+        blob.append(t.symbolNames[i]);
+        blob.push_back('\0');
+    }
+    h.numEntries = t.numEntries;
+    h.rhsSymbolCount = t.rhsBegin[t.numProductions];
+
+    string buf(sizeof h, '\0');
+    h.nameOffsets = appendSection(buf, nameOffsets.data(), nameOffsets.size() * sizeof(uint32_t));
+    h.names = appendSection(buf, blob.data(), blob.size());
+    h.namesSize = static_cast<uint32_t>(blob.size());
+    h.rowBase = appendSection(buf, t.rowBase, (t.numSymbols - t.numTerminals) * sizeof(uint32_t));
+    h.entries = appendSection(buf, t.entries, t.numEntries * sizeof(LL1Entry));
+    h.productionLhs = appendSection(buf, t.productionLhs, t.numProductions * sizeof(uint16_t));
+    h.rhsBegin = appendSection(buf, t.rhsBegin, (t.numProductions + 1u) * sizeof(uint16_t));
+    h.rhsSymbols = appendSection(buf, t.rhsSymbols, h.rhsSymbolCount * sizeof(uint16_t));
+    h.tokenTerminal = appendSection(buf, t.tokenTerminal, TOKEN_TYPE_COUNT * sizeof(int16_t));
+    h.fileSize = buf.size();
+    memcpy(&buf[0], &h, sizeof h);
+
+    // Write a temporary file and rename it, so a concurrent reader never
+    // maps a half-written table.
+    string tmp = path + ".tmp";
+    {
+        ofstream ofs(tmp, ios::binary | ios::trunc);
+        if (!ofs || !ofs.write(buf.data(), static_cast<streamsize>(buf.size()))) {
+            cerr << "Error: Unable to write " << tmp << endl;
+            return false;
+        }
+    }
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        cerr << "Error: Unable to rename " << tmp << " to " << path << endl;
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Checks that every ID in the table is in range, so a corrupt file cannot
+// send the parser outside its arrays. A few thousand comparisons at most.
+static bool idsInRange(const LL1Table &t, size_t rhsSymbolCount) {
+    if (t.startSymbol < t.numTerminals || t.startSymbol >= t.numSymbols || t.endTerminal >= t.numTerminals)
+        return false;
+    size_t numRows = t.numSymbols - t.numTerminals;
+    for (size_t r = 0; r < numRows; r++) {
+        if (t.rowBase[r] > t.numEntries - t.numTerminals)
+            return false;
+    }
+    for (size_t i = 0; i < t.numEntries; i++) {
+        const LL1Entry &e = t.entries[i];
+        if (e.row != LL1_NO_ROW && e.row >= numRows)
+            return false;
+        if (e.value >= t.numProductions || (e.value < 0 && e.value != LL1_ERROR && e.value != LL1_CONFLICT))
+            return false;
+    }
+    for (size_t p = 0; p < t.numProductions; p++) {
+        if (t.productionLhs[p] < t.numTerminals || t.productionLhs[p] >= t.numSymbols ||
+            t.rhsBegin[p] > t.rhsBegin[p + 1])
+            return false;
+    }
+    if (t.rhsBegin[0] != 0 || t.rhsBegin[t.numProductions] != rhsSymbolCount)
+        return false;
+    for (size_t i = 0; i < rhsSymbolCount; i++) {
+        if (t.rhsSymbols[i] >= t.numSymbols)
+            return false;
+    }
+    for (size_t i = 0; i < TOKEN_TYPE_COUNT; i++) {
+        if (t.tokenTerminal[i] >= t.numTerminals)
+            return false;
+    }
+    return true;
+}
+
+LL1TableFile::~LL1TableFile() {
+    close();
+}
+
+void LL1TableFile::close() {
+    if (mapping)
+        munmap(mapping, mappedSize);
+    mapping = nullptr;
+    mappedSize = 0;
+    names.clear();
+    view = {};
+}
+
+bool LL1TableFile::open(const string &path, uint64_t hash) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(LL1TableFileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    mappedSize = static_cast<size_t>(st.st_size);
+    void *p = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        mappedSize = 0;
+        return false;
+    }
+    mapping = p;
+
+    const char *base = static_cast<const char *>(mapping);
+    LL1TableFileHeader h;
+    memcpy(&h, base, sizeof h);
+    // A section is usable if it is aligned and lies inside the file.
+    auto fits = [&](uint32_t offset, size_t bytes) {
+        return offset % 8 == 0 && offset >= sizeof h && offset + bytes <= mappedSize;
+    };
+    bool ok = memcmp(h.magic, LL1_TABLE_MAGIC, sizeof h.magic) == 0 &&
+              h.version == LL1_TABLE_FILE_VERSION && h.tokenTypes == TOKEN_TYPE_COUNT &&
+              h.grammarHash == hash && h.fileSize == mappedSize &&
+              h.numTerminals > 0 && h.numTerminals <= h.numSymbols && h.numEntries >= h.numTerminals &&
+              fits(h.nameOffsets, h.numSymbols * sizeof(uint32_t)) &&
+              fits(h.names, h.namesSize) && h.namesSize > 0 && base[h.names + h.namesSize - 1] == '\0' &&
+              fits(h.rowBase, (h.numSymbols - h.numTerminals) * sizeof(uint32_t)) &&
+              fits(h.entries, h.numEntries * sizeof(LL1Entry)) &&
+              fits(h.productionLhs, h.numProductions * sizeof(uint16_t)) &&
+              fits(h.rhsBegin, (h.numProductions + 1u) * sizeof(uint16_t)) &&
+              fits(h.rhsSymbols, h.rhsSymbolCount * sizeof(uint16_t)) &&
+              fits(h.tokenTerminal, TOKEN_TYPE_COUNT * sizeof(int16_t));
+    if (!ok) {
+        close();
+        return false;
+    }
+
+    const uint32_t *nameOffsets = reinterpret_cast<const uint32_t *>(base + h.nameOffsets);
+    for (size_t i = 0; i < h.numSymbols; i++) {
+        if (nameOffsets[i] >= h.namesSize) {
+            close();
+            return false;
+        }
+        names.push_back(base + h.names + nameOffsets[i]);
+    }
+    view.numTerminals = h.numTerminals;
+    view.numSymbols = h.numSymbols;
+    view.numProductions = h.numProductions;
+    view.startSymbol = h.startSymbol;
+    view.endTerminal = h.endTerminal;
+    view.numEntries = h.numEntries;
+    view.symbolNames = names.data();
+    view.rowBase = reinterpret_cast<const uint32_t *>(base + h.rowBase);
+    view.entries = reinterpret_cast<const LL1Entry *>(base + h.entries);
+    view.productionLhs = reinterpret_cast<const uint16_t *>(base + h.productionLhs);
+    view.rhsBegin = reinterpret_cast<const uint16_t *>(base + h.rhsBegin);
+    view.rhsSymbols = reinterpret_cast<const uint16_t *>(base + h.rhsSymbols);
+    view.tokenTerminal = reinterpret_cast<const int16_t *>(base + h.tokenTerminal);
+    if (!idsInRange(view, h.rhsSymbolCount)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool GrammarTables::load(const string &grammarPath) {
+    vector<Production> grammar;
+    if (!readCFGGrammarFile(grammarPath, grammar))
+        return false;
+    uint64_t hash = grammarHash(grammar);
+    cacheFile = grammarPath + ".ll1";
+    if (file.open(cacheFile, hash)) {
+        view = file.table();
+        cached = true;
+        return true;
+    }
+
+    GrammarSets sets = computeGrammarSets(grammar);
+    auto first = firstSetsAsMap(sets);
+    auto follow = followSetsAsMap(sets);
+    auto parsingTable = constructParsingTable(grammar, first, follow);
+    compiled = compileLL1Table(grammar, parsingTable);
+    if (!compiled.conflicts.empty()) {
+        for (const auto &c : compiled.conflicts)
+            cerr << "Error: " << grammarPath << ": " << c << endl;
+        return false;
+    }
+    cached = false;
+    // Serve from the cache file just written when possible, so both paths
+    // use the same tables; otherwise keep the compiled ones in memory.
+    if (writeLL1TableFile(cacheFile, compiled.view(), hash) && file.open(cacheFile, hash))
+        view = file.table();
+    else
+        view = compiled.view();
+    return true;
+}
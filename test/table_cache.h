@@ -0,0 +1,66 @@
+#ifndef TABLE_CACHE_H
+#define TABLE_CACHE_H
+
+#include "grammar.h"
+#include "ll1_table.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Binary LL(1) table files. A file holds one LL1Table in the layout the
+// parser reads, so loading it is an mmap plus a header check. Files carry
+// a format version and a hash of the grammar they were compiled from; a
+// file with another version or hash is stale and is simply recompiled.
+
+// Bump whenever the file layout or the table encoding changes.
+const uint32_t LL1_TABLE_FILE_VERSION = 2;
+
+// FNV-1a hash of the productions, in order.
+uint64_t grammarHash(const vector<Production>& grammar);
+
+// Writes `table` to `path`. Reports failures on cerr.
+bool writeLL1TableFile(const string &path, const LL1Table &table, uint64_t hash);
+
+// A table file mapped read-only. The table stays valid until the object
+// is destroyed.
+class LL1TableFile {
+public:
+    LL1TableFile() = default;
+    ~LL1TableFile();
+    LL1TableFile(const LL1TableFile &) = delete;
+    LL1TableFile &operator=(const LL1TableFile &) = delete;
+
+    // Maps `path` and checks its header and bounds against `hash`.
+    // Returns false, without a message, for a missing or stale file.
+    bool open(const string &path, uint64_t hash);
+    const LL1Table &table() const { return view; }
+
+private:
+    void *mapping = nullptr;
+    size_t mappedSize = 0;
+    vector<const char *> names;   // Symbol names point into the mapping.
+    LL1Table view = {};
+    void close();
+};
+
+// LL(1) tables for a grammar file in CFG_grammar.txt format. The first
+// load compiles the grammar and caches the tables next to it, in
+// `<grammar file>.ll1`; later loads of the same grammar map that file.
+class GrammarTables {
+public:
+    // Reports errors, including LL(1) conflicts, on cerr.
+    bool load(const string &grammarPath);
+    const LL1Table &table() const { return view; }
+    bool fromCache() const { return cached; }
+    const string &cachePath() const { return cacheFile; }
+
+private:
+    LL1TableFile file;
+    LL1TableData compiled;    // Used when the cache cannot be written.
+    LL1Table view = {};
+    bool cached = false;
+    string cacheFile;
+};
+
+#endif // TABLE_CACHE_H
@@ -0,0 +1,297 @@
+// Build step: compiles the grammar from buildGrammar() into LL(1) tables and
+// writes them as static C++ arrays, so sql_parser starts without doing any
+// grammar analysis. With a second file name, also writes a recursive-descent
+// parser generated from the same tables.
+// Usage: ./tablegen ll1_builtin.cpp [rd_parser.cpp]
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "grammar.h"
+#include "ll1_table.h"
+using namespace std;
+
+// Writes `n` integers as the body of an array initializer.
+template <class T>
+static void writeArray(ostream &out, const char *type, const char *name, const T *values, size_t n) {
+    out << "static const " << type << " " << name << "[] = {";
+    for (size_t i = 0; i < n; i++) {
+        out << (i % 16 == 0 ? "\n    " : " ") << static_cast<long long>(values[i]) << ",";
+    }
+    out << "\n};\n\n";
+}
+
+static string quoted(const string &s) {
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static void writeTableSource(ostream &out, const LL1Table &t) {
+    size_t numNonTerminals = t.numSymbols - t.numTerminals;
+    out << "// Generated by tablegen from buildGrammar() in grammar.cpp. Do not edit;\n"
+        << "// rerun tablegen after changing the grammar (see run.txt).\n"
+        << "#include \"ll1_table.h\"\n\n";
+
+    out << "static const char *const symbolNames[] = {";
+    for (size_t i = 0; i < t.numSymbols; i++)
+        out << "\n    " << quoted(t.symbolNames[i]) << ",";
+    out << "\n};\n\n";
+    writeArray(out, "uint32_t", "rowBase", t.rowBase, numNonTerminals);
+    out << "static const LL1Entry entries[] = {";
+    for (size_t i = 0; i < t.numEntries; i++) {
+        out << (i % 8 == 0 ? "\n    " : " ") << "{" << t.entries[i].row << ", " << t.entries[i].value << "},";
+    }
+    out << "\n};\n\n";
+    writeArray(out, "uint16_t", "productionLhs", t.productionLhs, t.numProductions);
+    writeArray(out, "uint16_t", "rhsBegin", t.rhsBegin, t.numProductions + 1u);
+    writeArray(out, "uint16_t", "rhsSymbols", t.rhsSymbols, t.rhsBegin[t.numProductions]);
+    writeArray(out, "int16_t", "tokenTerminal", t.tokenTerminal, TOKEN_TYPE_COUNT);
+
+    out << "const LL1Table builtinLL1Table = {\n"
+        << "    " << t.numTerminals << ",  // numTerminals\n"
+        << "    " << t.numSymbols << ",  // numSymbols\n"
+        << "    " << t.numProductions << ",  // numProductions\n"
+        << "    " << t.startSymbol << ",  // startSymbol\n"
+        << "    " << t.endTerminal << ",  // endTerminal\n"
+        << "    " << t.numEntries << ",  // numEntries\n"
+        << "    symbolNames,\n"
+        << "    rowBase,\n"
+        << "    entries,\n"
+        << "    productionLhs,\n"
+        << "    rhsBegin,\n"
+        << "    rhsSymbols,\n"
+        << "    tokenTerminal,\n"
+        << "};\n";
+}
+
+// The TokenType enumerator for `type`, as it is spelled in C++.
+static string tokenTypeIdentifier(TokenType type) {
+    switch (type) {
+#define X(kw) case TokenType::kw: return #kw;
+        SQL_KEYWORDS(X)
+#undef X
+        case TokenType::LPAREN:      return "LPAREN";
+        case TokenType::RPAREN:      return "RPAREN";
+        case TokenType::COMMA:       return "COMMA";
+        case TokenType::SEMICOLON:   return "SEMICOLON";
+        case TokenType::ASTERISK:    return "ASTERISK";
+        case TokenType::EQUAL:       return "EQUAL";
+        case TokenType::GREATER:     return "GREATER";
+        case TokenType::LESS:        return "LESS";
+        case TokenType::IDENTIFIER:  return "IDENTIFIER";
+        case TokenType::NUMBER:      return "NUMBER";
+        case TokenType::STRING:      return "STRING";
+        case TokenType::ERROR:       return "ERROR";
+        case TokenType::END:         return "END";
+    }
+    return "";
+}
+
+// Member function name for a nonterminal: <create_table_stmt> becomes
+// parseCreateTableStmt.
+static string functionName(const string &nonTerminal) {
+    string name = "parse";
+    bool upper = true;
+    for (char c : nonTerminal) {
+        if (c == '<' || c == '>') continue;
+        if (c == '_') {
+            upper = true;
+            continue;
+        }
+        name += upper ? static_cast<char>(toupper(static_cast<unsigned char>(c))) : c;
+        upper = false;
+    }
+    return name;
+}
+
+// A production as `<lhs> ::= rhs`, for comments.
+static string productionText(const LL1Table &t, int16_t prod) {
+    string text = string(t.symbolNames[t.productionLhs[prod]]) + " ::=";
+    if (t.rhsBegin[prod] == t.rhsBegin[prod + 1])
+        return text + " EPSILON";
+    for (size_t k = t.rhsBegin[prod + 1]; k-- > t.rhsBegin[prod];)
+        text += string(" ") + t.symbolNames[t.rhsSymbols[k]];
+    return text;
+}
+
+// Writes a recursive-descent parser with one member function per
+// nonterminal. Each function switches on the token type, with one case
+// group per production the table predicts; terminal matches are inline
+// comparisons against the token type. A production ending in its own
+// nonterminal loops instead of recursing, so list tails (and the statement
+// list) do not grow the call stack. Errors go through the same
+// expectedError()/noRuleError() calls as ll1Run(), with builtinLL1Table
+// for the names, so messages match ll1Check() exactly.
+static void writeParserSource(ostream &out, const LL1Table &t) {
+    // Token types that read as each terminal.
+    vector<vector<string>> tokenTypes(t.numTerminals);
+    for (size_t type = 0; type < TOKEN_TYPE_COUNT; type++) {
+        if (t.tokenTerminal[type] >= 0)
+            tokenTypes[t.tokenTerminal[type]].push_back("TokenType::" + tokenTypeIdentifier(static_cast<TokenType>(type)));
+    }
+    // Condition that the current token does not read as `terminal`.
+    auto mismatch = [&](uint16_t terminal) {
+        if (tokenTypes[terminal].empty())
+            return string("true");
+        string cond;
+        for (const auto &type : tokenTypes[terminal])
+            cond += (cond.empty() ? "type != " : " && type != ") + type;
+        return cond;
+    };
+
+    out << "// Generated by tablegen from buildGrammar() in grammar.cpp. Do not edit;\n"
+        << "// rerun tablegen after changing the grammar (see run.txt).\n"
+        << "#include \"rd_parser.h\"\n"
+        << "#include \"parser.h\"\n\n"
+        << "namespace {\n\n"
+        << "class RDParser {\n"
+        << "public:\n"
+        << "    RDParser(const Token *tokens, size_t count, string &error)\n"
+        << "        : tokens(tokens), count(count), error(error) {}\n"
+        << "    bool parse();\n\n"
+        << "private:\n"
+        << "    const Token *tokens;\n"
+        << "    size_t count;\n"
+        << "    size_t i = 0;\n"
+        << "    string &error;\n\n"
+        << "    // Positions at or past `count` read as END, like \"$\" in ll1Run().\n"
+        << "    TokenType peek() const { return i < count ? tokens[i].type : TokenType::END; }\n"
+        << "    bool expected(uint16_t terminal) {\n"
+        << "        error = expectedError(tokens, count, i, builtinLL1Table, terminal);\n"
+        << "        return false;\n"
+        << "    }\n"
+        << "    bool noRule(uint16_t nonTerminal) {\n"
+        << "        error = noRuleError(tokens, count, i, builtinLL1Table, nonTerminal, LL1_ERROR);\n"
+        << "        return false;\n"
+        << "    }\n\n";
+    for (uint16_t nt = t.numTerminals; nt < t.numSymbols; nt++)
+        out << "    bool " << functionName(t.symbolNames[nt]) << "();\n";
+    out << "};\n\n";
+
+    out << "bool RDParser::parse() {\n"
+        << "    if (!" << functionName(t.symbolNames[t.startSymbol]) << "())\n"
+        << "        return false;\n"
+        << "    TokenType type = peek();\n"
+        << "    if (" << mismatch(t.endTerminal) << ")\n"
+        << "        return expected(" << t.endTerminal << ");\n"
+        << "    if (++i < count) {\n"
+        << "        error = \"Syntax Error: input not fully consumed.\";\n"
+        << "        return false;\n"
+        << "    }\n"
+        << "    return true;\n"
+        << "}\n";
+
+    for (uint16_t nt = t.numTerminals; nt < t.numSymbols; nt++) {
+        // Terminals predicting each production, in production order.
+        vector<pair<int16_t, vector<uint16_t>>> cases;
+        bool loops = false;
+        for (uint16_t term = 0; term < t.numTerminals; term++) {
+            int16_t prod = t.cell(nt, term);
+            if (prod < 0)
+                continue;
+            auto it = find_if(cases.begin(), cases.end(), [&](const auto &c) { return c.first == prod; });
+            if (it == cases.end()) {
+                cases.push_back({prod, {}});
+                it = cases.end() - 1;
+                loops |= t.rhsBegin[prod] != t.rhsBegin[prod + 1] && t.rhsSymbols[t.rhsBegin[prod]] == nt;
+            }
+            it->second.push_back(term);
+        }
+        sort(cases.begin(), cases.end());
+
+        string indent = loops ? "        " : "    ";
+        out << "\n// " << t.symbolNames[nt] << "\n"
+            << "bool RDParser::" << functionName(t.symbolNames[nt]) << "() {\n";
+        if (loops)
+            out << "    for (;;) {\n";
+        out << indent << "TokenType type = peek();\n"
+            << indent << "switch (type) {\n";
+        for (const auto &c : cases) {
+            int16_t prod = c.first;
+            for (uint16_t term : c.second) {
+                for (const auto &type : tokenTypes[term])
+                    out << indent << "case " << type << ":\n";
+            }
+            out << indent << "    // " << productionText(t, prod) << "\n";
+            // RHS in source order; the first terminal is the one just
+            // switched on, so it needs no test.
+            bool first = true;
+            bool tail = false;
+            for (size_t k = t.rhsBegin[prod + 1]; k-- > t.rhsBegin[prod]; first = false) {
+                uint16_t sym = t.rhsSymbols[k];
+                if (t.isTerminal(sym)) {
+                    if (!first) {
+                        out << indent << "    type = peek();\n"
+                            << indent << "    if (" << mismatch(sym) << ")\n"
+                            << indent << "        return expected(" << sym << ");\n";
+                    }
+                    out << indent << "    i++;\n";
+                } else if (k == t.rhsBegin[prod] && sym == nt) {
+                    out << indent << "    continue;\n";
+                    tail = true;
+                } else if (k == t.rhsBegin[prod]) {
+                    out << indent << "    return " << functionName(t.symbolNames[sym]) << "();\n";
+                    tail = true;
+                } else {
+                    out << indent << "    if (!" << functionName(t.symbolNames[sym]) << "())\n"
+                        << indent << "        return false;\n";
+                }
+            }
+            if (!tail)
+                out << indent << "    return true;\n";
+        }
+        out << indent << "default:\n"
+            << indent << "    return noRule(" << nt << ");\n"
+            << indent << "}\n";
+        if (loops)
+            out << "    }\n";
+        out << "}\n";
+    }
+
+    out << "\n}  // namespace\n\n"
+        << "bool rdCheck(const Token *tokens, size_t count, string &error) {\n"
+        << "    return RDParser(tokens, count, error).parse();\n"
+        << "}\n";
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2 && argc != 3) {
+        cerr << "Usage: " << argv[0] << " OUTPUT.cpp [PARSER.cpp]" << endl;
+        return 1;
+    }
+    vector<Production> grammar = buildGrammar();
+    GrammarSets sets = computeGrammarSets(grammar);
+    auto first = firstSetsAsMap(sets);
+    auto follow = followSetsAsMap(sets);
+    auto parsingTable = constructParsingTable(grammar, first, follow);
+    LL1TableData data = compileLL1Table(grammar, parsingTable);
+    if (!data.conflicts.empty()) {
+        for (const auto &c : data.conflicts)
+            cerr << "Error: " << c << endl;
+        return 1;
+    }
+
+    ofstream out(argv[1]);
+    if (!out) {
+        cerr << "Error: Unable to open file " << argv[1] << " for writing." << endl;
+        return 1;
+    }
+    writeTableSource(out, data.view());
+    cout << "LL(1) tables written to " << argv[1] << endl;
+    if (argc == 3) {
+        ofstream parser(argv[2]);
+        if (!parser) {
+            cerr << "Error: Unable to open file " << argv[2] << " for writing." << endl;
+            return 1;
+        }
+        writeParserSource(parser, data.view());
+        cout << "Recursive-descent parser written to " << argv[2] << endl;
+    }
+    return 0;
+}
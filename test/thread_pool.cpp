@@ -0,0 +1,103 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : job(nullptr), generation(0), stopping(false), active(0), remaining(0) {
+    if (threadCount == 0)
+        threadCount = max(1u, thread::hardware_concurrency());
+    for (unsigned i = 0; i < threadCount; i++)
+        queues.push_back(make_unique<Queue>());
+    // Worker 0 is whichever thread calls parallelFor.
+    for (unsigned i = 1; i < threadCount; i++)
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(jobLock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto &t : threads)
+        t.join();
+}
+
+bool ThreadPool::popOwn(unsigned worker, size_t &item) {
+    Queue &q = *queues[worker];
+    lock_guard<mutex> guard(q.lock);
+    if (q.items.empty())
+        return false;
+    item = q.items.back();
+    q.items.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(unsigned worker, size_t &item) {
+    for (unsigned k = 1; k < queues.size(); k++) {
+        Queue &q = *queues[(worker + k) % queues.size()];
+        lock_guard<mutex> guard(q.lock);
+        if (!q.items.empty()) {
+            item = q.items.front();
+            q.items.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs tasks until every queue is empty.
+void ThreadPool::drain(unsigned worker) {
+    size_t item;
+    while (popOwn(worker, item) || steal(worker, item)) {
+        (*job)(item, worker);
+        if (remaining.fetch_sub(1) == 1) {
+            lock_guard<mutex> guard(jobLock);
+            jobDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    size_t seen = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> guard(jobLock);
+            jobReady.wait(guard, [&] { return stopping || (generation != seen && job); });
+            if (stopping)
+                return;
+            seen = generation;
+            active++;
+        }
+        drain(worker);
+        {
+            lock_guard<mutex> guard(jobLock);
+            active--;
+        }
+        jobDone.notify_all();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const function<void(size_t, unsigned)> &task) {
+    if (count == 0)
+        return;
+    // Deal contiguous blocks so neighbouring tasks usually share a thread.
+    size_t block = (count + queues.size() - 1) / queues.size();
+    for (unsigned w = 0; w < queues.size(); w++) {
+        lock_guard<mutex> guard(queues[w]->lock);
+        for (size_t i = w * block; i < min(count, (w + 1) * block); i++)
+            queues[w]->items.push_back(i);
+    }
+    remaining = count;
+    {
+        lock_guard<mutex> guard(jobLock);
+        job = &task;
+        generation++;
+    }
+    jobReady.notify_all();
+
+    drain(0);
+
+    // Wait until every task has run and no worker still holds `task`.
+    unique_lock<mutex> guard(jobLock);
+    jobDone.wait(guard, [&] { return remaining == 0 && active == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Fixed set of worker threads with one task queue per worker. parallelFor
+// deals the task indices out in contiguous blocks; a worker pops from the
+// back of its own queue and, once that is empty, steals from the front of
+// the other queues, so uneven tasks (one huge statement batch, say) do not
+// leave threads idle.
+class ThreadPool {
+public:
+    // threads == 0 uses one thread per hardware core.
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    // Runs task(i, worker) for every i in [0, count) and returns when all
+    // have finished. `worker` is in [0, size()) and identifies the thread,
+    // for per-thread scratch state. The calling thread works as worker 0.
+    // Calls must not overlap.
+    void parallelFor(size_t count, const function<void(size_t, unsigned)> &task);
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<size_t> items;
+    };
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> threads;
+
+    mutex jobLock;
+    condition_variable jobReady;
+    condition_variable jobDone;
+    const function<void(size_t, unsigned)> *job;
+    size_t generation;
+    bool stopping;
+    unsigned active;            // Workers currently inside drain().
+    atomic<size_t> remaining;   // Tasks not yet finished.
+
+    bool popOwn(unsigned worker, size_t &item);
+    bool steal(unsigned worker, size_t &item);
+    void drain(unsigned worker);
+    void workerLoop(unsigned worker);
+};
+
+#endif // THREAD_POOL_H
@@ -1,25 +1,34 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 using namespace std;
 
+// SQL keywords. Adding an entry here adds its TokenType, its tokenName()
+// and its slot in the keyword hash table (keywords.h).
+#define SQL_KEYWORDS(X) \
+    X(CREATE)           \
+    X(TABLE)            \
+    X(PRIMARY)          \
+    X(KEY)              \
+    X(INSERT)           \
+    X(INTO)             \
+    X(VALUES)           \
+    X(SELECT)           \
+    X(FROM)             \
+    X(WHERE)            \
+    X(BETWEEN)          \
+    X(AND)              \
+    X(LIKE)             \
+    X(IN)
+
 // Token types for SQL.
 enum class TokenType {
-    CREATE,
-    TABLE,
-    PRIMARY,
-    KEY,
-    INSERT,
-    INTO,
-    VALUES,
-    SELECT,
-    FROM,
-    WHERE,
-    BETWEEN,
-    AND,
-    LIKE,
-    IN,
+#define X(kw) kw,
+    SQL_KEYWORDS(X)
+#undef X
     LPAREN,
     RPAREN,
     COMMA,
@@ -35,29 +44,31 @@ enum class TokenType {
     END
 };
 
+// No symbol: the token is not an interned identifier or literal.
+const uint32_t NO_SYMBOL = UINT32_MAX;
+
 // Structure representing a token.
+// The lexeme is a view into the source buffer; only string literals that
+// needed unescaping and error messages point into the lexer's literal pool.
+// Either way the Lexer (and its input) must outlive the tokens.
 struct Token {
-    TokenType type;
-    string lexeme;
+    TokenType type = TokenType::END;
+    // Symbol ID of an IDENTIFIER, NUMBER or STRING (symbols.h), when the
+    // lexer interns that kind of token; otherwise NO_SYMBOL.
+    uint32_t symbol = NO_SYMBOL;
+    string_view lexeme;
+    size_t offset = 0;   // Byte offset of the token in the source buffer.
+
+    Token() = default;
+    Token(TokenType type, string_view lexeme, size_t offset = 0) : type(type), lexeme(lexeme), offset(offset) {}
 };
 
 // Converts a TokenType value to a human-readable string.
 inline string tokenName(TokenType t) {
     switch(t) {
-        case TokenType::CREATE:      return "CREATE";
-        case TokenType::TABLE:       return "TABLE";
-        case TokenType::PRIMARY:     return "PRIMARY";
-        case TokenType::KEY:         return "KEY";
-        case TokenType::INSERT:      return "INSERT";
-        case TokenType::INTO:        return "INTO";
-        case TokenType::VALUES:      return "VALUES";
-        case TokenType::SELECT:      return "SELECT";
-        case TokenType::FROM:        return "FROM";
-        case TokenType::WHERE:       return "WHERE";
-        case TokenType::BETWEEN:     return "BETWEEN";
-        case TokenType::AND:         return "AND";
-        case TokenType::LIKE:        return "LIKE";
-        case TokenType::IN:          return "IN";
+#define X(kw) case TokenType::kw: return #kw;
+        SQL_KEYWORDS(X)
+#undef X
         case TokenType::LPAREN:      return "(";
         case TokenType::RPAREN:      return ")";
         case TokenType::COMMA:       return ",";
@@ -0,0 +1,72 @@
+#ifndef TOKEN_RING_H
+#define TOKEN_RING_H
+
+#include "token.h"
+#include <cstddef>
+#include <string>
+using namespace std;
+
+// Fixed-size ring of tokens between a lexer and the parser, so a script
+// can be parsed while it is lexed. The parser only ever looks at the
+// current token; when the ring is drained it is topped up from the lexer
+// with up to N tokens at a time, so each side runs in a short tight loop
+// and no token vector is ever built.
+//
+// Every slot owns a copy of its lexeme: a StreamLexer lexeme only lives
+// until its next call. Slot strings keep their capacity, so once the ring
+// has seen a few long lexemes, copying allocates nothing.
+//
+// A token source for ll1Run(): current() is null once the lexer has
+// returned END, which the parser reads as "$".
+template <class Lex, size_t N = 64>
+class TokenRing {
+public:
+    explicit TokenRing(Lex &lexer) : lexer(lexer) {}
+    TokenRing(const TokenRing &) = delete;
+    TokenRing &operator=(const TokenRing &) = delete;
+
+    const Token *current() {
+        if (size == 0 && !ended)
+            fill();
+        return size ? &slots[head].token : nullptr;
+    }
+    void advance() {
+        if (size == 0)
+            return;
+        head = (head + 1) % N;
+        size--;
+        consumedCount++;
+    }
+    // Tokens the parser has moved past.
+    size_t consumed() const { return consumedCount; }
+
+private:
+    struct Slot {
+        Token token;
+        string text;
+    };
+
+    void fill() {
+        while (size < N) {
+            Token tok = lexer.nextToken();
+            if (tok.type == TokenType::END) {
+                ended = true;
+                return;
+            }
+            Slot &slot = slots[(head + size) % N];
+            slot.text.assign(tok.lexeme.data(), tok.lexeme.size());
+            slot.token = tok;
+            slot.token.lexeme = slot.text;
+            size++;
+        }
+    }
+
+    Lex &lexer;
+    Slot slots[N];
+    size_t head = 0;     // Slot of the current token.
+    size_t size = 0;     // Tokens lexed but not yet consumed.
+    size_t consumedCount = 0;
+    bool ended = false;
+};
+
+#endif // TOKEN_RING_H
@@ -1,10 +1,17 @@
 #include "utils.h"
+#include "ll1_table.h"
+#include "stats.h"
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include "symbols.h"
 #include "token.h"
 using namespace std;
 
 void generateCFGGrammarFile(const vector<Production>& grammar, const string &filename) {
+    STATS_PHASE(Phase::WriteGrammar);
     ofstream ofs(filename);
     if (!ofs) {
         cerr << "Error: Unable to open file " << filename << " for writing." << endl;
@@ -22,10 +29,68 @@ void generateCFGGrammarFile(const vector<Production>& grammar, const string &fil
     cout << "\nCFG grammar has been written to " << filename << endl;
 }
 
+bool readCFGGrammarFile(const string &filename, vector<Production> &grammar) {
+    ifstream ifs(filename);
+    if (!ifs) {
+        cerr << "Error: Unable to open file " << filename << " for reading." << endl;
+        return false;
+    }
+    grammar.clear();
+    string line;
+    for (int lineNo = 1; getline(ifs, line); lineNo++) {
+        istringstream words(line);
+        string lhs, arrow;
+        if (!(words >> lhs) || lhs.compare(0, 3, "===") == 0)
+            continue;   // Blank line or the === header/footer.
+        Production prod{lhs, {}};
+        string sym;
+        while (words >> sym)
+            prod.rhs.push_back(sym);
+        if (!isNonTerminal(lhs) || prod.rhs.empty() || prod.rhs.front() != "::=" || prod.rhs.size() < 2) {
+            cerr << "Error: " << filename << ":" << lineNo << ": expected '<nonterminal> ::= symbols...'" << endl;
+            return false;
+        }
+        prod.rhs.erase(prod.rhs.begin());
+        grammar.push_back(move(prod));
+    }
+    if (grammar.empty()) {
+        cerr << "Error: " << filename << " contains no productions." << endl;
+        return false;
+    }
+    return true;
+}
+
+// Size of the parsing table as a map, as a dense array and compressed. Map
+// sizes count the nodes and vectors, assuming 32 bytes of red-black tree
+// overhead per node, and ignore string heap storage. `sql_bench tables`
+// times a lookup in each.
+static void writeTableStats(ostream &ofs, const vector<Production>& grammar,
+                            const map<pair<string, string>, vector<int>> &parsingTable) {
+    LL1TableData data = compileLL1Table(grammar, parsingTable);
+    LL1Table t = data.view();
+    size_t rows = t.numSymbols - t.numTerminals;
+    size_t cells = rows * t.numTerminals;
+    size_t used = 0;
+    for (size_t i = 0; i < t.numEntries; i++)
+        used += t.entries[i].row != LL1_NO_ROW;
+    size_t mapBytes = 0;
+    for (const auto &entry : parsingTable)
+        mapBytes += 32 + sizeof(entry) + entry.second.capacity() * sizeof(int);
+
+    ofs << "\n=== Parsing Table Encoding ===\n";
+    ofs << "table: " << rows << " nonterminals x " << t.numTerminals << " terminals, "
+        << parsingTable.size() << " non-error cells of " << cells << "\n";
+    ofs << "map: " << mapBytes << " bytes\n";
+    ofs << "dense: " << cells * sizeof(int16_t) << " bytes\n";
+    ofs << "row displacement: " << t.tableBytes() << " bytes (" << t.numEntries << " slots, "
+        << used << " used)\n";
+}
+
 void writeParsingInfoToFile(const vector<Production>& grammar,
                             const map<string, set<string>> &first,
                             const map<string, set<string>> &follow,
                             const map<pair<string, string>, vector<int>> &parsingTable) {
+    STATS_PHASE(Phase::WriteParsingTable);
     ofstream ofs("parsing_table.txt");
     if (!ofs) {
         cerr << "Error opening output file." << endl;
@@ -64,49 +129,55 @@ void writeParsingInfoToFile(const vector<Production>& grammar,
         }
     }
     
+    writeTableStats(ofs, grammar, parsingTable);
     ofs.close();
     cout << "\nFIRST sets, FOLLOW sets, and parsing table written to parsing_table.txt" << endl;
 }
 
 void generateSymbolTableFile(const vector<Token>& tokens, const string &filename) {
-    // Separate hash tables for each token category.
-    unordered_map<string, Token> identifierTable;   // For IDENTIFIER tokens.
-    unordered_map<string, Token> numberTable;       // For NUMBER tokens.
-    unordered_map<string, Token> stringTable;       // For STRING tokens.
-    unordered_map<string, Token> keywordTable;      // For keywords.
-    unordered_map<string, Token> symbolTable;       // For punctuation and operators.
+    STATS_PHASE(Phase::WriteSymbolTable);
+    // Identifiers, numbers and strings are told apart by symbol ID, so each
+    // is hashed as one integer and its text is never copied; keywords and
+    // symbols, a handful of fixed lexemes, by their text. Every section
+    // lists its entries in order of first appearance.
+    SymbolPool &pool = symbolPool();
+    IdMap listed;                                       // Symbol IDs seen so far.
+    vector<uint32_t> identifierTable;                   // For IDENTIFIER tokens.
+    vector<uint32_t> numberTable;                       // For NUMBER tokens.
+    vector<uint32_t> stringTable;                       // For STRING tokens.
+    vector<pair<string_view, TokenType>> keywordTable;  // For keywords.
+    vector<pair<string_view, TokenType>> symbolTable;   // For punctuation and operators.
+
+    auto addSymbol = [&](vector<uint32_t> &table, SymbolKind kind, const Token &tok) {
+        uint32_t id = tok.symbol != NO_SYMBOL ? tok.symbol : pool.intern(kind, tok.lexeme);
+        if (listed.insert(id, 0))
+            table.push_back(id);
+    };
+    auto addLexeme = [](vector<pair<string_view, TokenType>> &table, const Token &tok) {
+        for (const auto &entry : table) {
+            if (entry.second == tok.type && entry.first == tok.lexeme)
+                return;
+        }
+        table.push_back({tok.lexeme, tok.type});
+    };
 
     // Process each token and insert into the appropriate table.
     for (const auto &tok : tokens) {
-        // Skip the END token.
-        if (tok.type == TokenType::END) continue;
-        
         switch (tok.type) {
             case TokenType::IDENTIFIER:
-                identifierTable[tok.lexeme] = tok;
+                addSymbol(identifierTable, SymbolKind::Identifier, tok);
                 break;
             case TokenType::NUMBER:
-                numberTable[tok.lexeme] = tok;
+                addSymbol(numberTable, SymbolKind::Number, tok);
                 break;
             case TokenType::STRING:
-                stringTable[tok.lexeme] = tok;
+                addSymbol(stringTable, SymbolKind::String, tok);
                 break;
             // Group all keyword token types.
-            case TokenType::CREATE:
-            case TokenType::TABLE:
-            case TokenType::PRIMARY:
-            case TokenType::KEY:
-            case TokenType::INSERT:
-            case TokenType::INTO:
-            case TokenType::VALUES:
-            case TokenType::SELECT:
-            case TokenType::FROM:
-            case TokenType::WHERE:
-            case TokenType::BETWEEN:
-            case TokenType::AND:
-            case TokenType::LIKE:
-            case TokenType::IN:
-                keywordTable[tok.lexeme] = tok;
+#define X(kw) case TokenType::kw:
+            SQL_KEYWORDS(X)
+#undef X
+                addLexeme(keywordTable, tok);
                 break;
             // For symbols such as punctuation and operators.
             case TokenType::LPAREN:
@@ -117,10 +188,10 @@ void generateSymbolTableFile(const vector<Token>& tokens, const string &filename
             case TokenType::EQUAL:
             case TokenType::GREATER:
             case TokenType::LESS:
-                symbolTable[tok.lexeme] = tok;
+                addLexeme(symbolTable, tok);
                 break;
             default:
-                break;
+                break;  // END and ERROR.
         }
     }
     
@@ -134,29 +205,24 @@ void generateSymbolTableFile(const vector<Token>& tokens, const string &filename
     ofs << "=== Symbol Table ===\n";
     
     ofs << "\n--- Identifiers ---\n";
-    for (const auto &entry : identifierTable) {
-        ofs << entry.first << "\t(" << tokenName(entry.second.type) << ")\n";
-    }
+    for (uint32_t id : identifierTable)
+        ofs << pool.text(id) << "\t(" << tokenName(TokenType::IDENTIFIER) << ")\n";
     
     ofs << "\n--- Numbers ---\n";
-    for (const auto &entry : numberTable) {
-        ofs << entry.first << "\t(" << tokenName(entry.second.type) << ")\n";
-    }
+    for (uint32_t id : numberTable)
+        ofs << pool.text(id) << "\t(" << tokenName(TokenType::NUMBER) << ")\n";
     
     ofs << "\n--- String Literals ---\n";
-    for (const auto &entry : stringTable) {
-        ofs << entry.first << "\t(" << tokenName(entry.second.type) << ")\n";
-    }
+    for (uint32_t id : stringTable)
+        ofs << pool.text(id) << "\t(" << tokenName(TokenType::STRING) << ")\n";
     
     ofs << "\n--- Keywords ---\n";
-    for (const auto &entry : keywordTable) {
-        ofs << entry.first << "\t(" << tokenName(entry.second.type) << ")\n";
-    }
+    for (const auto &entry : keywordTable)
+        ofs << entry.first << "\t(" << tokenName(entry.second) << ")\n";
     
     ofs << "\n--- Symbols ---\n";
-    for (const auto &entry : symbolTable) {
-        ofs << entry.first << "\t(" << tokenName(entry.second.type) << ")\n";
-    }
+    for (const auto &entry : symbolTable)
+        ofs << entry.first << "\t(" << tokenName(entry.second) << ")\n";
     
     ofs << "\n=====================\n";
     ofs.close();
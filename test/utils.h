@@ -10,6 +10,10 @@ using namespace std;
 
 // Prototypes for utility functions.
 void generateCFGGrammarFile(const vector<Production>& grammar, const string &filename);
+// Reads a grammar in the format generateCFGGrammarFile() writes, one
+// `<lhs> ::= sym sym ...` production per line ("EPSILON" for an empty
+// RHS). Reports the first malformed line on cerr.
+bool readCFGGrammarFile(const string &filename, vector<Production> &grammar);
 void writeParsingInfoToFile(const vector<Production>& grammar,
                             const map<string, set<string>> &first,
                             const map<string, set<string>> &follow,
@@ -0,0 +1,256 @@
+#include "workload.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+static const char *const MIX_NAMES[] = {"balanced", "wide", "strings", "in", "mixed"};
+
+bool parseWorkloadMix(const string &name, WorkloadMix &mix) {
+    for (size_t m = 0; m < sizeof MIX_NAMES / sizeof MIX_NAMES[0]; m++) {
+        if (name == MIX_NAMES[m]) {
+            mix = static_cast<WorkloadMix>(m);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *workloadMixName(WorkloadMix mix) {
+    return MIX_NAMES[static_cast<size_t>(mix)];
+}
+
+bool parseByteSize(const string &text, uint64_t &bytes) {
+    char *end;
+    unsigned long long n = strtoull(text.c_str(), &end, 10);
+    string unit = end;
+    if (end == text.c_str())
+        return false;
+    if (unit.empty() || unit == "B")
+        bytes = n;
+    else if (unit == "KB" || unit == "K")
+        bytes = n << 10;
+    else if (unit == "MB" || unit == "M")
+        bytes = n << 20;
+    else if (unit == "GB" || unit == "G")
+        bytes = n << 30;
+    else
+        return false;
+    return true;
+}
+
+static const char *const TABLE_NAMES[] = {
+    "customers", "orders", "line_items", "products", "suppliers", "shipments", "invoices", "payments",
+};
+const size_t TABLE_NAMES_COUNT = sizeof TABLE_NAMES / sizeof TABLE_NAMES[0];
+static const char *const WORDS[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+    "india", "juliet", "kilo", "lima", "mike", "november", "oscar", "papa",
+};
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadOptions &options) : options(options), rng(options.seed) {
+    for (const char *name : TABLE_NAMES)
+        addTable(name, 4 + pick(7));
+    if (options.mix == WorkloadMix::WideValues || options.mix == WorkloadMix::Mixed) {
+        for (int w = 0; w < 4; w++) {
+            wideTables.push_back(tables.size());
+            addTable("wide_events_" + to_string(w), 32 + pick(65));
+        }
+    }
+}
+
+void WorkloadGenerator::addTable(const string &name, size_t columns) {
+    Table t;
+    t.name = name;
+    t.columns.push_back("id");
+    t.types.push_back(ColumnType::Int);
+    for (size_t c = 1; c < columns; c++) {
+        t.columns.push_back(string(WORDS[pick(16)]) + "_" + to_string(c));
+        t.types.push_back(static_cast<ColumnType>(pick(3)));
+    }
+    tables.push_back(move(t));
+}
+
+void WorkloadGenerator::appendCreate(string &out, const Table &t) {
+    static const char *const TYPE_NAMES[] = {"INT", "DECIMAL", "VARCHAR"};
+    out += "CREATE TABLE ";
+    out += t.name;
+    out += " (";
+    for (size_t c = 0; c < t.columns.size(); c++) {
+        out += t.columns[c];
+        out += ' ';
+        out += TYPE_NAMES[static_cast<size_t>(t.types[c])];
+        out += ", ";
+    }
+    out += "PRIMARY KEY (id));\n";
+}
+
+// `length` bytes of words, with an occasional doubled quote.
+void WorkloadGenerator::appendString(string &out, size_t length) {
+    out += '\'';
+    size_t start = out.size();
+    while (out.size() - start < length) {
+        if (out.size() > start)
+            out += pick(32) ? " " : " ''";
+        out += WORDS[pick(16)];
+    }
+    out += '\'';
+}
+
+void WorkloadGenerator::appendValue(string &out, ColumnType type, WorkloadMix flavour) {
+    switch (type) {
+        case ColumnType::Int:
+            out += to_string(rng() % 100000000);
+            break;
+        case ColumnType::Decimal:
+            out += to_string(rng() % 100000);
+            out += '.';
+            out += to_string(rng() % 100);
+            break;
+        case ColumnType::Varchar:
+            appendString(out, flavour == WorkloadMix::LongStrings ? 200 + pick(3801) : 4 + pick(28));
+            break;
+    }
+}
+
+void WorkloadGenerator::appendInsert(string &out, const Table &t, WorkloadMix flavour) {
+    out += "INSERT INTO ";
+    out += t.name;
+    // A column list of the first k columns, or none (all of them).
+    size_t count = t.columns.size();
+    if (flavour != WorkloadMix::WideValues && pick(2)) {
+        count = 1 + pick(t.columns.size());
+        out += " (";
+        for (size_t c = 0; c < count; c++) {
+            if (c)
+                out += ", ";
+            out += t.columns[c];
+        }
+        out += ')';
+    }
+    out += " VALUES (";
+    for (size_t c = 0; c < count; c++) {
+        if (c)
+            out += ", ";
+        appendValue(out, t.types[c], flavour);
+    }
+    out += ");\n";
+}
+
+void WorkloadGenerator::appendSelect(string &out, const Table &t, WorkloadMix flavour) {
+    out += "SELECT ";
+    if (pick(4) == 0) {
+        out += '*';
+    } else {
+        size_t count = 1 + pick(min<size_t>(t.columns.size(), 6));
+        for (size_t c = 0; c < count; c++) {
+            if (c)
+                out += ", ";
+            out += t.columns[pick(t.columns.size())];
+        }
+    }
+    out += " FROM ";
+    out += t.name;
+    if (flavour == WorkloadMix::DeepIn) {
+        out += " WHERE id IN (";
+        size_t count = 100 + pick(901);
+        for (size_t v = 0; v < count; v++) {
+            if (v)
+                out += ", ";
+            out += to_string(rng() % 100000000);
+        }
+        out += ");\n";
+        return;
+    }
+    if (pick(5) == 0) {
+        out += ";\n";
+        return;
+    }
+    size_t c = pick(t.columns.size());
+    ColumnType type = t.types[c];
+    out += " WHERE ";
+    out += t.columns[c];
+    switch (type == ColumnType::Varchar ? 6 + pick(2) : pick(6)) {
+        case 0: out += " = "; appendValue(out, type, flavour); break;
+        case 1: out += " > "; appendValue(out, type, flavour); break;
+        case 2: out += " < "; appendValue(out, type, flavour); break;
+        case 3:
+        case 4:
+            out += " BETWEEN ";
+            appendValue(out, type, flavour);
+            out += " AND ";
+            appendValue(out, type, flavour);
+            break;
+        case 5:
+            out += " IN (";
+            for (size_t v = 0, n = 2 + pick(8); v < n; v++) {
+                if (v)
+                    out += ", ";
+                appendValue(out, type, flavour);
+            }
+            out += ')';
+            break;
+        case 6: out += " = "; appendValue(out, type, flavour); break;
+        default:
+            out += " LIKE '";
+            out += WORDS[pick(16)];
+            out += "%'";
+            break;
+    }
+    out += ";\n";
+}
+
+bool WorkloadGenerator::next(string &out, size_t chunkBytes) {
+    size_t start = out.size();
+    while (!done && out.size() - start < chunkBytes) {
+        if (created < tables.size()) {
+            appendCreate(out, tables[created++]);
+        } else if (generated + (out.size() - start) >= options.bytes) {
+            done = true;
+            break;
+        } else {
+            WorkloadMix flavour = options.mix;
+            if (flavour == WorkloadMix::Mixed)
+                flavour = static_cast<WorkloadMix>(pick(4));
+            if (flavour == WorkloadMix::WideValues) {
+                appendInsert(out, tables[wideTables[pick(wideTables.size())]], flavour);
+            } else if (flavour == WorkloadMix::DeepIn || pick(2)) {
+                appendSelect(out, tables[pick(TABLE_NAMES_COUNT)], flavour);
+            } else {
+                appendInsert(out, tables[pick(TABLE_NAMES_COUNT)], flavour);
+            }
+        }
+        statements++;
+    }
+    generated += out.size() - start;
+    return out.size() > start;
+}
+
+string generateWorkload(const WorkloadOptions &options) {
+    WorkloadGenerator gen(options);
+    string out;
+    out.reserve(options.bytes + (64 << 10));
+    while (gen.next(out)) {
+    }
+    return out;
+}
+
+bool writeWorkload(const string &path, const WorkloadOptions &options) {
+    FILE *f = path == "-" ? stdout : fopen(path.c_str(), "wb");
+    if (!f) {
+        cerr << "Error: Unable to open file " << path << " for writing." << endl;
+        return false;
+    }
+    WorkloadGenerator gen(options);
+    string chunk;
+    bool ok = true;
+    while (ok && gen.next(chunk)) {
+        ok = fwrite(chunk.data(), 1, chunk.size(), f) == chunk.size();
+        chunk.clear();
+    }
+    if ((f != stdout && fclose(f) != 0) || (f == stdout && fflush(f) != 0))
+        ok = false;
+    if (!ok)
+        cerr << "Error: writing " << path << " failed." << endl;
+    return ok;
+}
@@ -0,0 +1,83 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Seeded synthetic SQL workloads for benchmarks. A workload starts with
+// CREATE TABLE statements for its schema, followed by INSERT and SELECT
+// statements on those tables, one per line. Every statement is valid and
+// consistent with the schema: column names exist and INSERT values match
+// the columns' count and types. The same options always give the same
+// bytes.
+
+enum class WorkloadMix : uint8_t {
+    Balanced,       // Short INSERTs and SELECTs with all kinds of WHERE.
+    WideValues,     // INSERTs into tables of 32 to 96 columns.
+    LongStrings,    // String literals of 200 to 4000 bytes.
+    DeepIn,         // SELECTs with IN lists of 100 to 1000 values.
+    Mixed,          // Each statement drawn from one of the above.
+};
+
+bool parseWorkloadMix(const string &name, WorkloadMix &mix);
+const char *workloadMixName(WorkloadMix mix);
+
+// Parses "4096", "1KB", "64MB", "10GB" (binary units).
+bool parseByteSize(const string &text, uint64_t &bytes);
+
+struct WorkloadOptions {
+    uint64_t bytes = 64 << 20;      // Stop after the statement that reaches this.
+    WorkloadMix mix = WorkloadMix::Balanced;
+    uint64_t seed = 1;
+};
+
+// Generates a workload piecewise, so that any size can be streamed to a
+// file without holding it in memory.
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadOptions &options);
+
+    // Appends whole statements to `out` until it has grown by `chunkBytes`
+    // or the workload is complete. Returns false once nothing is left.
+    bool next(string &out, size_t chunkBytes = 1 << 20);
+
+    uint64_t bytesGenerated() const { return generated; }
+    uint64_t statementsGenerated() const { return statements; }
+
+private:
+    enum class ColumnType : uint8_t { Int, Decimal, Varchar };
+    struct Table {
+        string name;
+        vector<string> columns;     // columns[0] is the primary key.
+        vector<ColumnType> types;
+    };
+
+    void addTable(const string &name, size_t columns);
+    void appendCreate(string &out, const Table &t);
+    void appendInsert(string &out, const Table &t, WorkloadMix flavour);
+    void appendSelect(string &out, const Table &t, WorkloadMix flavour);
+    void appendValue(string &out, ColumnType type, WorkloadMix flavour);
+    void appendString(string &out, size_t length);
+    size_t pick(size_t n) { return static_cast<size_t>(rng() % n); }
+
+    WorkloadOptions options;
+    mt19937_64 rng;
+    vector<Table> tables;
+    vector<size_t> wideTables;      // Indexes of the tables for WideValues.
+    size_t created = 0;             // CREATE TABLE statements written so far.
+    bool done = false;
+    uint64_t generated = 0;
+    uint64_t statements = 0;
+};
+
+// The whole workload in memory.
+string generateWorkload(const WorkloadOptions &options);
+
+// Streams the workload to `path` ("-" for stdout). Returns false with a
+// message on cerr if the file cannot be written.
+bool writeWorkload(const string &path, const WorkloadOptions &options);
+
+#endif // WORKLOAD_H